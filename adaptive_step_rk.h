@@ -33,46 +33,437 @@
 /** @brief Instantiate delete_results_rkab under suffixed symbol for type T
  * @details I'll use this in results_rkab.cpp through MAP_TARGETS_TO().*/
 #define INST_DELETE_RESULTS_RKAB(T, Tid) \
-    void delete_results_rkab##Tid(results_rkab<T> *results) \
-    {   delete_results_rkab<T>(results);   }
+    void delete_results_rkab##Tid(results_rkab<T> *results)             \
+    {   delete_results_rkab<T>(results);   }                            \
+    void delete_results_rkab_array##Tid(results_rkab<T> **results, int num) \
+    {   delete_results_rkab_array<T>(results, num);   }
+
+/** @brief Instantiate the accessor of the statistics of results_rkab under
+ * suffixed symbol for type T
+ * @details I'll use this in results_rkab.cpp through MAP_TARGETS_TO().*/
+#define INST_RESULTS_RKAB_STATS(T, Tid) \
+    const rkab_stats *results_rkab_stats##Tid(const results_rkab<T> *results) \
+    {   return results->stats;   }
+
+/** @brief Instantiate the rkab_context API under suffixed symbols for type T
+ * @details I'll use this in results_rkab.cpp through MAP_TARGETS_TO().*/
+#define INST_RKAB_CONTEXT(T, Tid) \
+    rkab_context<T> *rkab_context_create##Tid(int dim, int capacity)      \
+    {   return new rkab_context<T>(dim, capacity);   }                    \
+    void rkab_context_reset##Tid(rkab_context<T> *ctx)                     \
+    {   ctx->reset();   }                                                  \
+    void rkab_context_destroy##Tid(rkab_context<T> *ctx)                   \
+    {   delete ctx;   }
+
+/** @brief Instantiate the rkab_async API under suffixed symbols for type T
+ * @details I'll use this in results_rkab.cpp through MAP_TARGETS_TO().*/
+#define INST_RKAB_ASYNC_API(T, Tid) \
+    int rkab_async_poll##Tid(rkab_async<T> *a, T *t, int *numsteps,        \
+                             int *numfailures)                             \
+    {   return a->poll(t, numsteps, numfailures);   }                      \
+    void rkab_async_cancel##Tid(rkab_async<T> *a)                          \
+    {   a->cancel();   }                                                   \
+    const results_rkab<T> *rkab_async_wait##Tid(rkab_async<T> *a)          \
+    {   return a->wait();   }                                              \
+    results_rkab<T> *rkab_async_results##Tid(rkab_async<T> *a)             \
+    {   return a->snapshot();   }                                          \
+    void rkab_async_destroy##Tid(rkab_async<T> *a)                         \
+    {   delete a;   }
 
 /** @brief Instantiate rkab under suffixed symbol with types and tableau bound
  * @details I'll use this in implementation files (eg., 'rk45.cpp', 'rk23.cpp')
- * through MAP_TARGETS_TO(). */
-#define INST_RKAB(sfx, T, tolT, order, astages, bstages, ba, bb, a, c) \
+ * through MAP_TARGETS_TO(). 'Tab' is the tableau type of the method. */
+#define INST_RKAB(sfx, T, tolT, Tab) \
+    results_rkab<T> *rk##sfx(T *u_init, int dim, int maxsteps, tolT tol,  \
+                             T t, T t_end, void (*get_f)(T, T*, T*))      \
+    {   return rkab<Tab, T, tolT>(u_init, dim, maxsteps, tol,             \
+                                  t, t_end, get_f);                       }
+
+/** @brief Instantiate rkab_context::solve under suffixed symbol with types
+ * and tableau bound
+ * @details As INST_RKAB, for solves in a context. */
+#define INST_RKAB_SOLVE(sfx, T, tolT, Tab) \
+    const results_rkab<T> *rk##sfx(rkab_context<T> *ctx, T *u_init,        \
+                                   int maxsteps, tolT tol, T t, T t_end,   \
+                                   void (*get_f)(T, T*, T*))               \
+    {   return ctx->template solve<Tab, tolT>(u_init, maxsteps, tol,       \
+                                              t, t_end, get_f);            }
+
+/** @brief Instantiate rkab_opt under suffixed symbol with types and tableau
+ * bound
+ * @details As INST_RKAB, for the solvers of rkab_control.hpp. */
+#define INST_RKAB_OPT(sfx, T, Tab) \
+    results_rkab<T> *rk##sfx(T *u_init, int dim, int maxsteps,             \
+                             const rkab_options<T> *opts, T t, T t_end,    \
+                             void (*get_f)(T, T*, T*))                     \
+    {   return rkab_opt<Tab, T>(u_init, dim, maxsteps, opts,               \
+                                t, t_end, get_f);                          }
+
+/** @brief Instantiate rkab_batch under suffixed symbol with types and tableau
+ * bound
+ * @details As INST_RKAB, for the batched solvers of rkab_batch.hpp. */
+#define INST_RKAB_BATCH(sfx, T, tolT, Tab) \
+    results_rkab<T> **rk##sfx(T *u_init, int dim, int num, int maxsteps,  \
+                              tolT tol, T t, T t_end,                     \
+                              void (*get_f)(T*, T*, T*, int))             \
+    {   return rkab_batch<Tab, T, tolT>(u_init, dim, num, maxsteps, tol,  \
+                                        t, t_end, get_f);                 }
+
+/** @brief Instantiate rkab_ensemble under suffixed symbol with types and
+ * tableau bound
+ * @details As INST_RKAB, for the multithreaded solvers of rkab_ensemble.hpp. */
+#define INST_RKAB_ENSEMBLE(sfx, T, tolT, Tab) \
+    results_rkab<T> **rk##sfx(T *u_init, int dim, int num, int maxsteps,  \
+                              T *tol, T *t, T *t_end,                     \
+                              void (*get_f)(T, T*, T*), int numthreads)   \
+    {   return rkab_ensemble<Tab, T, tolT>(u_init, dim, num, maxsteps,    \
+                                           tol, t, t_end, get_f,          \
+                                           numthreads);                   }
+
+/** @brief Instantiate rkab_observe under suffixed symbol with types and
+ * tableau bound
+ * @details As INST_RKAB, for the streaming solvers of rkab_observe.hpp. */
+#define INST_RKAB_OBSERVE(sfx, T, tolT, Tab) \
+    int rk##sfx(T *u_init, int dim, int maxsteps, tolT tol, T t, T t_end, \
+                void (*get_f)(T, T*, T*), rkab_observer<T> *obs,          \
+                int *numfailures)                                         \
+    {   return rkab_observe<Tab, T, tolT>(u_init, dim, maxsteps, tol,     \
+                                          t, t_end, get_f, obs,           \
+                                          numfailures);                   }
+
+/** @brief Instantiate rkab_npy under suffixed symbol with types and tableau
+ * bound
+ * @details As INST_RKAB, for the solvers writing .npy files of rkab_npy.hpp. */
+#define INST_RKAB_NPY(sfx, T, tolT, Tab) \
+    int rk##sfx(T *u_init, int dim, int maxsteps, tolT tol, T t, T t_end, \
+                void (*get_f)(T, T*, T*), const char *t_path,             \
+                const char *u_path, int *numfailures)                     \
+    {   return rkab_npy<Tab, T, tolT>(u_init, dim, maxsteps, tol, t,      \
+                                      t_end, get_f, t_path, u_path,       \
+                                      numfailures);                       }
+
+/** @brief Instantiate rkab_events_solve under suffixed symbol with types and
+ * tableau bound
+ * @details As INST_RKAB, for the event detecting solvers of rkab_events.hpp. */
+#define INST_RKAB_EVENTS(sfx, T, tolT, Tab) \
+    results_rkab<T> *rk##sfx(T *u_init, int dim, int maxsteps, tolT tol,  \
+                             T t, T t_end, void (*get_f)(T, T*, T*),      \
+                             rkab_events<T> *ev)                          \
+    {   return rkab_events_solve<Tab, T, tolT>(u_init, dim, maxsteps,     \
+                                               tol, t, t_end, get_f, ev); }
+
+/** @brief Instantiate rkab_parareal under suffixed symbol with types and
+ * tableau bound
+ * @details As INST_RKAB, for the parallel-in-time solvers of
+ * rkab_parareal.hpp. */
+#define INST_RKAB_PARAREAL(sfx, T, tolT, Tab) \
+    results_rkab<T> *rk##sfx(T *u_init, int dim, int maxsteps, tolT tol,  \
+                             T t, T t_end, void (*get_f)(T, T*, T*),      \
+                             rkab_parareal_options<T> *opts)              \
+    {   return rkab_parareal<Tab, T, tolT>(u_init, dim, maxsteps, tol,    \
+                                           t, t_end, get_f, opts);        }
+
+/** @brief Instantiate rkab_teval under suffixed symbol with types and
+ * tableau bound
+ * @details As INST_RKAB, for the dense output solvers of rkab_dense.hpp. */
+#define INST_RKAB_TEVAL(sfx, T, tolT, Tab) \
+    results_rkab<T> *rk##sfx(T *u_init, int dim, int maxsteps, tolT tol,  \
+                             T t, T t_end, void (*get_f)(T, T*, T*),      \
+                             T *t_eval, int n_eval)                       \
+    {   return rkab_teval<Tab, T, tolT>(u_init, dim, maxsteps, tol,       \
+                                        t, t_end, get_f, t_eval, n_eval); }
+
+/** @brief Instantiate rkab_parallel under suffixed symbol with types and
+ * tableau bound
+ * @details As INST_RKAB, for the solvers of rkab_parallel.hpp, parallel
+ * within each step. */
+#define INST_RKAB_PARALLEL(sfx, T, tolT, Tab) \
+    int rk##sfx(T *u_init, int dim, int maxsteps, tolT tol, T t, T t_end, \
+                void (*get_f)(T, T*, T*),                                 \
+                void (*get_f_range)(T, T*, T*, int, int), int numthreads, \
+                rkab_observer<T> *obs, int *numfailures)                  \
+    {   return rkab_parallel<Tab, T, tolT>(u_init, dim, maxsteps, tol, t, \
+                                           t_end, get_f, get_f_range,     \
+                                           numthreads, obs, numfailures); }
+
+/** @brief Instantiate rkab_multirate under suffixed symbol with types and
+ * tableau bound
+ * @details As INST_RKAB, for the multirate solvers of rkab_multirate.hpp. */
+#define INST_RKAB_MULTIRATE(sfx, T, tolT, Tab) \
+    results_rkab<T> *rk##sfx(T *u_init, int dim, int dim_fast,            \
+                             int maxsteps, tolT tol, T t, T t_end,        \
+                             void (*get_f_fast)(T, T*, T*),               \
+                             void (*get_f_slow)(T, T*, T*))               \
+    {   return rkab_multirate<Tab, T, tolT>(u_init, dim, dim_fast,        \
+                                            maxsteps, tol, t, t_end,      \
+                                            get_f_fast, get_f_slow);      }
+
+/** @brief Instantiate rkab_async::start under suffixed symbol with types
+ * and tableau bound
+ * @details As INST_RKAB, for solves in the background; see rkab_async.hpp. */
+#define INST_RKAB_ASYNC(sfx, T, tolT, Tab) \
+    rkab_async<T> *rk##sfx(T *u_init, int dim, int maxsteps, tolT tol,    \
+                           T t, T t_end, void (*get_f)(T, T*, T*))        \
+    {   return rkab_async<T>::template start<Tab, tolT>(u_init, dim,      \
+                                                        maxsteps, tol, t, \
+                                                        t_end, get_f);    }
+
+/** @brief Instantiate rkls under suffixed symbol with types and tableau
+ * bound
+ * @details As INST_RKAB, for the low-storage solvers of rkls.hpp. I'll use
+ * this in 'rkls43.cpp' through MAP_TARGETS_TO(). */
+#define INST_RKLS(sfx, T, tolT, Tab) \
     results_rkab<T> *rk##sfx(T *u_init, int dim, int maxsteps, tolT tol,  \
                              T t, T t_end, void (*get_f)(T, T*, T*))      \
-    {   return rkab<T, tolT>(order, astages, bstages, ba, bb, a, c,       \
-                             u_init, dim, maxsteps, tol, t, t_end, get_f);}
+    {   return rkls<Tab, T, tolT>(u_init, dim, maxsteps, tol, t, t_end,   \
+                                  get_f);                                 }
+
+/** @brief Instantiate rkls_observe under suffixed symbol with types and
+ * tableau bound
+ * @details As INST_RKAB_OBSERVE, for the low-storage solvers of rkls.hpp. */
+#define INST_RKLS_OBSERVE(sfx, T, tolT, Tab) \
+    int rk##sfx(T *u_init, int dim, int maxsteps, tolT tol, T t, T t_end, \
+                void (*get_f)(T, T*, T*), rkab_observer<T> *obs,          \
+                int *numfailures)                                         \
+    {   return rkls_observe<Tab, T, tolT>(u_init, dim, maxsteps, tol,     \
+                                          t, t_end, get_f, obs,           \
+                                          numfailures);                   }
+
+/** @brief Instantiate rkab_mixed under suffixed symbol with types and
+ * tableau bound
+ * @details As INST_RKAB, for the mixed-precision solvers of rkab_mixed.hpp,
+ * with wide type TS and narrow type TF. These are not mapped to the targets
+ * but instantiated for the one pair (double, float). */
+#define INST_RKAB_MIXED(sfx, TS, TF, tolT, Tab) \
+    results_rkab<TS> *rk##sfx(TS *u_init, int dim, int maxsteps, tolT tol, \
+                              TS t, TS t_end, void (*get_f)(TF, TF*, TF*)) \
+    {   return rkab_mixed<Tab, TS, TF, tolT>(u_init, dim, maxsteps, tol,   \
+                                             t, t_end, get_f);             }
+
+/** @brief Instantiate rosenbrock under suffixed symbol with types bound
+ * @details I'll use this in 'ros23.cpp' through MAP_TARGETS_TO(). */
+#define INST_ROSENBROCK(sfx, T, tolT) \
+    results_rkab<T> *ros##sfx(T *u_init, int dim, int maxsteps, tolT tol, \
+                              T t, T t_end, void (*get_f)(T, T*, T*),     \
+                              void (*get_J)(T, T*, T*), int ml, int mu)   \
+    {   return rosenbrock<T, tolT>(u_init, dim, maxsteps, tol, t, t_end,  \
+                                   get_f, get_J, ml, mu);                 }
+
+/** @brief Instantiate rosenbrock_opt under suffixed symbol with type bound
+ * @details As INST_ROSENBROCK, for the solvers taking rkab_options. */
+#define INST_ROSENBROCK_OPT(sfx, T) \
+    results_rkab<T> *ros##sfx(T *u_init, int dim, int maxsteps,            \
+                              const rkab_options<T> *opts, T t, T t_end,   \
+                              void (*get_f)(T, T*, T*),                    \
+                              void (*get_J)(T, T*, T*), int ml, int mu)    \
+    {   return rosenbrock_opt<T>(u_init, dim, maxsteps, opts, t, t_end,    \
+                                 get_f, get_J, ml, mu);                    }
 
 // Expose C-extern interfaces of instantiated functions
 // @cond EXPOSE
 
 #ifndef __cplusplus 
     // We're included in a C context to define the library interface.
+    #define RKAB_STATS_BINS 64
+    #define RKAB_STATS_BIN_ONE 48
+    typedef struct rkab_stats {
+        long numevals; long numrejections;
+        long numpessimistic; long maxpessimistic; long numhmin;
+        long hhist[RKAB_STATS_BINS];
+        double seconds_f; double seconds_output; double seconds_kernel;
+    } rkab_stats;
     #define TYPEDEF_RESULTS_RKAB(T, Tid) \
         typedef struct results_rkab##Tid {             \
             int numsteps; T *t; T *u; int numfailures; \
+            rkab_stats *stats;                         \
         } results_rkab##Tid;
     MAP_TARGETS_TO(TYPEDEF_RESULTS_RKAB)
+    #define TYPEDEF_RKAB_OBSERVER(T, Tid) \
+        typedef struct rkab_observer##Tid {                          \
+            int stride; int capacity; T *t; T *u;                    \
+            void (*observe)(int count, T *t, T *u, void *data);      \
+            void *data; int numrows;                                 \
+        } rkab_observer##Tid;
+    MAP_TARGETS_TO(TYPEDEF_RKAB_OBSERVER)
+    enum rkab_norm { RKAB_NORM_RMS, RKAB_NORM_MAX };
+    enum rkab_controller { RKAB_CONTROL_I, RKAB_CONTROL_PI, RKAB_CONTROL_PID };
+    #define TYPEDEF_RKAB_OPTIONS(T, Tid) \
+        typedef struct rkab_options##Tid {                           \
+            T rtol; T atol; T *rtols; T *atols;                      \
+            int norm; int controller; T h0;                          \
+        } rkab_options##Tid;
+    MAP_TARGETS_TO(TYPEDEF_RKAB_OPTIONS)
+    #define TYPEDEF_RKAB_EVENTS(T, Tid) \
+        typedef struct rkab_events##Tid {                            \
+            int num; void (*get_g)(T t, T *u, T *g);                 \
+            int *direction; int *terminal;                           \
+            int capacity; T *t; T *u; int *which; int count;         \
+        } rkab_events##Tid;
+    MAP_TARGETS_TO(TYPEDEF_RKAB_EVENTS)
+    #define TYPEDEF_RKAB_PARAREAL_OPTIONS(T, Tid) \
+        typedef struct rkab_parareal_options##Tid {                  \
+            int numslices; int coarsesteps; T tol; int maxiter;      \
+            int numthreads; int numiter;                             \
+        } rkab_parareal_options##Tid;
+    MAP_TARGETS_TO(TYPEDEF_RKAB_PARAREAL_OPTIONS)
     // Very sorry about this. C'est la C.
     #define RESULTS_RKAB(T, Tid) results_rkab##Tid
+    #define RKAB_OBSERVER(T, Tid) rkab_observer##Tid
+    #define RKAB_OPTIONS(T, Tid) rkab_options##Tid
+    #define RKAB_EVENTS(T, Tid) rkab_events##Tid
+    #define RKAB_PARAREAL_OPTIONS(T, Tid) rkab_parareal_options##Tid
+    // Opaque; see rkab_context in rkab.hpp
+    #define TYPEDEF_RKAB_CONTEXT(T, Tid) \
+        typedef struct rkab_context##Tid rkab_context##Tid;
+    MAP_TARGETS_TO(TYPEDEF_RKAB_CONTEXT)
+    #define RKAB_CONTEXT(T, Tid) rkab_context##Tid
+    // Opaque; see rkab_async in rkab_async.hpp
+    #define TYPEDEF_RKAB_ASYNC(T, Tid) \
+        typedef struct rkab_async##Tid rkab_async##Tid;
+    MAP_TARGETS_TO(TYPEDEF_RKAB_ASYNC)
+    #define RKAB_ASYNC(T, Tid) rkab_async##Tid
 #else
 // We're included in a C++ context for library compilation.
 #define RESULTS_RKAB(T, Tid) results_rkab<T> // use the structure template
+#define RKAB_OBSERVER(T, Tid) rkab_observer<T>
+#define RKAB_OPTIONS(T, Tid) rkab_options<T>
+#define RKAB_EVENTS(T, Tid) rkab_events<T>
+#define RKAB_PARAREAL_OPTIONS(T, Tid) rkab_parareal_options<T>
+#define RKAB_CONTEXT(T, Tid) rkab_context<T>
+#define RKAB_ASYNC(T, Tid) rkab_async<T>
 extern "C" { // use C linkage. Forbids symbol mangling (and thus overloading)
 #endif
 
 #define EXPOSE_DELETE_RESULTS_RKAB(T, Tid) \
-    void delete_results_rkab##Tid(RESULTS_RKAB(T, Tid)*);
+    void delete_results_rkab##Tid(RESULTS_RKAB(T, Tid)*); \
+    void delete_results_rkab_array##Tid(RESULTS_RKAB(T, Tid)**, int);
 // for results_rkab.cpp
 MAP_TARGETS_TO(EXPOSE_DELETE_RESULTS_RKAB)
 
+#define EXPOSE_RESULTS_RKAB_STATS(T, Tid) \
+    const rkab_stats *results_rkab_stats##Tid(const RESULTS_RKAB(T, Tid)*);
+// for results_rkab.cpp
+MAP_TARGETS_TO(EXPOSE_RESULTS_RKAB_STATS)
+
+#define EXPOSE_RKAB_CONTEXT(T, Tid) \
+    RKAB_CONTEXT(T, Tid) *rkab_context_create##Tid(int dim, int capacity); \
+    void rkab_context_reset##Tid(RKAB_CONTEXT(T, Tid) *ctx);               \
+    void rkab_context_destroy##Tid(RKAB_CONTEXT(T, Tid) *ctx);
+// for results_rkab.cpp
+MAP_TARGETS_TO(EXPOSE_RKAB_CONTEXT)
+
+#define EXPOSE_RKAB_ASYNC(T, Tid) \
+    int rkab_async_poll##Tid(RKAB_ASYNC(T, Tid) *a, T *t, int *numsteps,   \
+                             int *numfailures);                            \
+    void rkab_async_cancel##Tid(RKAB_ASYNC(T, Tid) *a);                    \
+    const RESULTS_RKAB(T, Tid) *rkab_async_wait##Tid(RKAB_ASYNC(T, Tid) *a);\
+    RESULTS_RKAB(T, Tid) *rkab_async_results##Tid(RKAB_ASYNC(T, Tid) *a);  \
+    void rkab_async_destroy##Tid(RKAB_ASYNC(T, Tid) *a);
+// for results_rkab.cpp
+MAP_TARGETS_TO(EXPOSE_RKAB_ASYNC)
+
 #define EXPOSE_RKAB(AB, T, Tid) \
     RESULTS_RKAB(T, Tid) *rk##AB##Tid                                      \
                                 (T *u_init, int dim, int maxsteps, T tol,  \
                                  T t, T t_end, void (*get_f)(T, T*, T*));  \
     RESULTS_RKAB(T, Tid) *rk##AB##_arrtol##Tid                             \
+                                (T *u_init, int dim, int maxsteps, T *tol, \
+                                 T t, T t_end, void (*get_f)(T, T*, T*));  \
+    const RESULTS_RKAB(T, Tid) *rk##AB##_solve##Tid                        \
+                                (RKAB_CONTEXT(T, Tid) *ctx, T *u_init,     \
+                                 int maxsteps, T tol, T t, T t_end,        \
+                                 void (*get_f)(T, T*, T*));                \
+    const RESULTS_RKAB(T, Tid) *rk##AB##_solve_arrtol##Tid                 \
+                                (RKAB_CONTEXT(T, Tid) *ctx, T *u_init,     \
+                                 int maxsteps, T *tol, T t, T t_end,       \
+                                 void (*get_f)(T, T*, T*));                \
+    RESULTS_RKAB(T, Tid) *rk##AB##_opt##Tid                                \
+                                (T *u_init, int dim, int maxsteps,         \
+                                 const RKAB_OPTIONS(T, Tid) *opts,         \
+                                 T t, T t_end, void (*get_f)(T, T*, T*));  \
+    RESULTS_RKAB(T, Tid) **rk##AB##_batch##Tid                             \
+                                (T *u_init, int dim, int num, int maxsteps,\
+                                 T tol, T t, T t_end,                      \
+                                 void (*get_f)(T*, T*, T*, int));          \
+    RESULTS_RKAB(T, Tid) **rk##AB##_batch_arrtol##Tid                      \
+                                (T *u_init, int dim, int num, int maxsteps,\
+                                 T *tol, T t, T t_end,                     \
+                                 void (*get_f)(T*, T*, T*, int));          \
+    RESULTS_RKAB(T, Tid) **rk##AB##_ensemble##Tid                          \
+                                (T *u_init, int dim, int num, int maxsteps,\
+                                 T *tol, T *t, T *t_end,                   \
+                                 void (*get_f)(T, T*, T*), int numthreads);\
+    RESULTS_RKAB(T, Tid) **rk##AB##_ensemble_arrtol##Tid                   \
+                                (T *u_init, int dim, int num, int maxsteps,\
+                                 T *tol, T *t, T *t_end,                   \
+                                 void (*get_f)(T, T*, T*), int numthreads);\
+    int rk##AB##_observe##Tid(T *u_init, int dim, int maxsteps, T tol,     \
+                              T t, T t_end, void (*get_f)(T, T*, T*),      \
+                              RKAB_OBSERVER(T, Tid) *obs, int *numfailures);\
+    int rk##AB##_observe_arrtol##Tid(T *u_init, int dim, int maxsteps,     \
+                                     T *tol, T t, T t_end,                 \
+                                     void (*get_f)(T, T*, T*),             \
+                                     RKAB_OBSERVER(T, Tid) *obs,           \
+                                     int *numfailures);                    \
+    int rk##AB##_npy##Tid(T *u_init, int dim, int maxsteps, T tol,         \
+                          T t, T t_end, void (*get_f)(T, T*, T*),          \
+                          const char *t_path, const char *u_path,          \
+                          int *numfailures);                               \
+    int rk##AB##_npy_arrtol##Tid(T *u_init, int dim, int maxsteps, T *tol, \
+                                 T t, T t_end, void (*get_f)(T, T*, T*),   \
+                                 const char *t_path, const char *u_path,   \
+                                 int *numfailures);                        \
+    RESULTS_RKAB(T, Tid) *rk##AB##_events##Tid                             \
+                                (T *u_init, int dim, int maxsteps, T tol,  \
+                                 T t, T t_end, void (*get_f)(T, T*, T*),   \
+                                 RKAB_EVENTS(T, Tid) *ev);                 \
+    RESULTS_RKAB(T, Tid) *rk##AB##_events_arrtol##Tid                      \
+                                (T *u_init, int dim, int maxsteps, T *tol, \
+                                 T t, T t_end, void (*get_f)(T, T*, T*),   \
+                                 RKAB_EVENTS(T, Tid) *ev);                 \
+    RESULTS_RKAB(T, Tid) *rk##AB##_parareal##Tid                           \
+                                (T *u_init, int dim, int maxsteps, T tol,  \
+                                 T t, T t_end, void (*get_f)(T, T*, T*),   \
+                                 RKAB_PARAREAL_OPTIONS(T, Tid) *opts);     \
+    RESULTS_RKAB(T, Tid) *rk##AB##_parareal_arrtol##Tid                    \
+                                (T *u_init, int dim, int maxsteps, T *tol, \
+                                 T t, T t_end, void (*get_f)(T, T*, T*),   \
+                                 RKAB_PARAREAL_OPTIONS(T, Tid) *opts);     \
+    RESULTS_RKAB(T, Tid) *rk##AB##_teval##Tid                              \
+                                (T *u_init, int dim, int maxsteps, T tol,  \
+                                 T t, T t_end, void (*get_f)(T, T*, T*),   \
+                                 T *t_eval, int n_eval);                   \
+    RESULTS_RKAB(T, Tid) *rk##AB##_teval_arrtol##Tid                       \
+                                (T *u_init, int dim, int maxsteps, T *tol, \
+                                 T t, T t_end, void (*get_f)(T, T*, T*),   \
+                                 T *t_eval, int n_eval);                   \
+    int rk##AB##_parallel##Tid(T *u_init, int dim, int maxsteps, T tol,    \
+                               T t, T t_end, void (*get_f)(T, T*, T*),     \
+                               void (*get_f_range)(T, T*, T*, int, int),   \
+                               int numthreads, RKAB_OBSERVER(T, Tid) *obs, \
+                               int *numfailures);                          \
+    int rk##AB##_parallel_arrtol##Tid(T *u_init, int dim, int maxsteps,    \
+                                      T *tol, T t, T t_end,                \
+                                      void (*get_f)(T, T*, T*),            \
+                                      void (*get_f_range)(T, T*, T*, int,  \
+                                                          int),            \
+                                      int numthreads,                      \
+                                      RKAB_OBSERVER(T, Tid) *obs,          \
+                                      int *numfailures);                   \
+    RESULTS_RKAB(T, Tid) *rk##AB##_multirate##Tid                          \
+                                (T *u_init, int dim, int dim_fast,         \
+                                 int maxsteps, T tol, T t, T t_end,        \
+                                 void (*get_f_fast)(T, T*, T*),            \
+                                 void (*get_f_slow)(T, T*, T*));           \
+    RESULTS_RKAB(T, Tid) *rk##AB##_multirate_arrtol##Tid                   \
+                                (T *u_init, int dim, int dim_fast,         \
+                                 int maxsteps, T *tol, T t, T t_end,       \
+                                 void (*get_f_fast)(T, T*, T*),            \
+                                 void (*get_f_slow)(T, T*, T*));           \
+    RKAB_ASYNC(T, Tid) *rk##AB##_async##Tid                                \
+                                (T *u_init, int dim, int maxsteps, T tol,  \
+                                 T t, T t_end, void (*get_f)(T, T*, T*));  \
+    RKAB_ASYNC(T, Tid) *rk##AB##_async_arrtol##Tid                         \
                                 (T *u_init, int dim, int maxsteps, T *tol, \
                                  T t, T t_end, void (*get_f)(T, T*, T*));
 //  for rk45.cpp
@@ -84,6 +475,65 @@ MAP_TARGETS_TO(EXPOSE_RK23)
 //  for rk45.cpp
 #define EXPOSE_RK12(T, Tid) EXPOSE_RKAB(12, T, Tid)
 MAP_TARGETS_TO(EXPOSE_RK12)
+//  for rkdp54.cpp
+#define EXPOSE_RKDP54(T, Tid) EXPOSE_RKAB(dp54, T, Tid)
+MAP_TARGETS_TO(EXPOSE_RKDP54)
+//  for rkbs32.cpp
+#define EXPOSE_RKBS32(T, Tid) EXPOSE_RKAB(bs32, T, Tid)
+MAP_TARGETS_TO(EXPOSE_RKBS32)
+
+#define EXPOSE_RKLS(AB, T, Tid) \
+    RESULTS_RKAB(T, Tid) *rk##AB##Tid                                      \
+                                (T *u_init, int dim, int maxsteps, T tol,  \
+                                 T t, T t_end, void (*get_f)(T, T*, T*));  \
+    RESULTS_RKAB(T, Tid) *rk##AB##_arrtol##Tid                             \
+                                (T *u_init, int dim, int maxsteps, T *tol, \
+                                 T t, T t_end, void (*get_f)(T, T*, T*));  \
+    int rk##AB##_observe##Tid(T *u_init, int dim, int maxsteps, T tol,     \
+                              T t, T t_end, void (*get_f)(T, T*, T*),      \
+                              RKAB_OBSERVER(T, Tid) *obs, int *numfailures);\
+    int rk##AB##_observe_arrtol##Tid(T *u_init, int dim, int maxsteps,     \
+                                     T *tol, T t, T t_end,                 \
+                                     void (*get_f)(T, T*, T*),             \
+                                     RKAB_OBSERVER(T, Tid) *obs,           \
+                                     int *numfailures);
+//  for rkls43.cpp
+#define EXPOSE_RKLS43(T, Tid) EXPOSE_RKLS(ls43, T, Tid)
+MAP_TARGETS_TO(EXPOSE_RKLS43)
+
+//  mixed precision: float stages, double state
+#define EXPOSE_RKAB_MIXED(AB) \
+    RESULTS_RKAB(double, _d) *rk##AB##_fd                                  \
+                            (double *u_init, int dim, int maxsteps,        \
+                             double tol, double t, double t_end,           \
+                             void (*get_f)(float, float*, float*));        \
+    RESULTS_RKAB(double, _d) *rk##AB##_arrtol_fd                           \
+                            (double *u_init, int dim, int maxsteps,        \
+                             double *tol, double t, double t_end,          \
+                             void (*get_f)(float, float*, float*));
+EXPOSE_RKAB_MIXED(45)
+EXPOSE_RKAB_MIXED(23)
+EXPOSE_RKAB_MIXED(12)
+EXPOSE_RKAB_MIXED(dp54)
+EXPOSE_RKAB_MIXED(bs32)
+
+#define EXPOSE_ROSENBROCK(AB, T, Tid) \
+    RESULTS_RKAB(T, Tid) *ros##AB##Tid                                     \
+                                (T *u_init, int dim, int maxsteps, T tol,  \
+                                 T t, T t_end, void (*get_f)(T, T*, T*),   \
+                                 void (*get_J)(T, T*, T*), int ml, int mu);\
+    RESULTS_RKAB(T, Tid) *ros##AB##_arrtol##Tid                            \
+                                (T *u_init, int dim, int maxsteps, T *tol, \
+                                 T t, T t_end, void (*get_f)(T, T*, T*),   \
+                                 void (*get_J)(T, T*, T*), int ml, int mu);\
+    RESULTS_RKAB(T, Tid) *ros##AB##_opt##Tid                               \
+                                (T *u_init, int dim, int maxsteps,         \
+                                 const RKAB_OPTIONS(T, Tid) *opts,         \
+                                 T t, T t_end, void (*get_f)(T, T*, T*),   \
+                                 void (*get_J)(T, T*, T*), int ml, int mu);
+//  for ros23.cpp
+#define EXPOSE_ROS23(T, Tid) EXPOSE_ROSENBROCK(23, T, Tid)
+MAP_TARGETS_TO(EXPOSE_ROS23)
 
 #ifdef __cplusplus
 } // closing brace for extern "C"
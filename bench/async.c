@@ -0,0 +1,86 @@
+/** @file
+ * @brief Benchmark of the solves run in the background.
+ * @details Solves the Lorenz system to t = 1000 with rk45_d and with
+ * rk45_async_d, printing the time of each and the overhead of publishing
+ * every step to the handle. Then starts a solve of a hundred thousand (or as
+ * many as given) decaying components which would run for far too long,
+ * cancels it after 100 ms, and prints the steps polled and copied out just
+ * before, how long the cancellation took to take effect, and the steps kept
+ * and the parameter reached.
+ * Usage: async [dim]
+ * @author Jeremiah O'Neil
+ * @copyright GNU Public License. */
+#include "../adaptive_step_rk.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static void get_f_lorenz(double t, double *u, double *f)
+{
+    f[0] = 10 * (u[1] - u[0]);
+    f[1] = u[0] * (28 - u[2]) - u[1];
+    f[2] = u[0] * u[1] - 8 / 3. * u[2];
+}
+
+/* Components decaying at rates from 1 to 2. */
+static int dim_decay;
+static void get_f_decay(double t, double *u, double *f)
+{
+    for (int i = 0; i < dim_decay; ++i) {
+        f[i] = -(1 + (double)i / dim_decay) * u[i];
+    }
+}
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+int main(int argc, char **argv)
+{
+    dim_decay = (argc > 1) ? atoi(argv[1]) : 100000;
+    const int maxsteps = 10000000;
+    double u0[3] = {1, 1, 1};
+
+    printf("method,steps,seconds,overhead\n");
+    double start = now();
+    results_rkab_d *res = rk45_d(u0, 3, maxsteps, 1e-8, 0, 1000,
+                                 get_f_lorenz);
+    double base = now() - start;
+    printf("rk45,%d,%.4f,1.00\n", res->numsteps, base);
+    delete_results_rkab_d(res);
+    start = now();
+    rkab_async_d *job = rk45_async_d(u0, 3, maxsteps, 1e-8, 0, 1000,
+                                     get_f_lorenz);
+    const results_rkab_d *res_async = rkab_async_wait_d(job);
+    double seconds = now() - start;
+    printf("rk45_async,%d,%.4f,%.2f\n", res_async->numsteps, seconds,
+           seconds / base);
+    rkab_async_destroy_d(job);
+
+    double *u_decay = malloc(dim_decay * sizeof(double));
+    for (int i = 0; i < dim_decay; ++i) {
+        u_decay[i] = 1;
+    }
+    job = rk45_async_d(u_decay, dim_decay, maxsteps, 1e-10, 0, 1e6,
+                       get_f_decay);
+    struct timespec delay = {0, 100000000};
+    nanosleep(&delay, NULL);
+    int polled;
+    rkab_async_poll_d(job, NULL, &polled, NULL);
+    results_rkab_d *part = rkab_async_results_d(job); // without waiting
+    start = now();
+    rkab_async_cancel_d(job);
+    res_async = rkab_async_wait_d(job);
+    double latency = now() - start;
+    printf("\ncancelled after 100 ms,polled_steps,copied_steps,latency_ms,"
+           "steps,t\n");
+    printf("rk45_async,%d,%d,%.3f,%d,%.4e\n", polled, part->numsteps,
+           1e3 * latency, res_async->numsteps,
+           res_async->t[res_async->numsteps - 1]);
+    delete_results_rkab_d(part);
+    rkab_async_destroy_d(job);
+    free(u_decay);
+}
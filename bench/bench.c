@@ -0,0 +1,186 @@
+/** @file
+ * @brief Benchmark suite of the solver library.
+ * @details Solves a standard set of problems (a harmonic oscillator, the
+ * Lorenz system, the Arenstorf orbit, a Van der Pol oscillator and a
+ * Brusselator with diffusion) with every exported method, for every data
+ * type, for scalar and array relative tolerance and for the options of the
+ * '_opt' methods (equal absolute and relative tolerance in the RMS norm, with
+ * PI step size control), and prints one CSV row per solve:
+ * the wall time (the best of several runs), the accepted steps and the steps
+ * where a failure occured (however many attempts each took), the
+ * derivative calls and calls per second, and the largest absolute error
+ * of the final state against a long double reference computed at tolerance
+ * 1e-16. Rows with t_final short of t_end hit maxsteps.
+ * Usage: bench [brusselator_points]
+ * @author Jeremiah O'Neil
+ * @copyright GNU Public License. */
+#include "../euler.h"
+#include "../adaptive_step_rk.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <tgmath.h>
+#include <time.h>
+
+#define CAT_(a, b) a##b
+#define CAT(a, b) CAT_(a, b)
+#define STR_(a) #a
+#define STR(a) STR_(a)
+
+/// The number of explicit Runge-Kutta methods; ros23 follows them.
+#define NUM_RK 5
+static const char *method_names[] = {
+    "rk12", "rk23", "rk45", "rkbs32", "rkdp54", "ros23"
+};
+
+/// Tolerance modes: relative scalar, relative array, and rkab_options.
+enum { TOL_SCALAR, TOL_ARRAY, TOL_OPT, NUM_TOL };
+static const char *tol_names[] = {"scalar", "array", "opt"};
+
+/* Each solve is repeated at least reps_min and at most reps_max times, and
+ * until time_min has passed. */
+static const int reps_min = 3, reps_max = 100;
+static const double time_min = 0.2;
+
+static long numcalls; // derivative calls of the current solve
+static int brusselator_n = 64; // grid points of the Brusselator
+
+struct problem
+{
+    int id; // index into the derivative tables
+    const char *name;
+    int dim;
+    double t_end;
+    double tol;
+    int maxsteps;
+    int eulersteps; // number of steps of the fixed-step methods
+    int ml, mu; // Jacobian bandwidths for ros23, or -1 if dense
+    long double *u0;
+};
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+static void print_row(const struct problem *p, const char *method,
+                      const char *type, int mode, double tol, int steps,
+                      int failed, long double t_final, long calls,
+                      double seconds, double error)
+{
+    printf("%s,%d,%s,%s,%s,%.1e,%d,%d,%.17Lg,%ld,%.6f,%.4g,%.4e\n",
+           p->name, p->dim, method, type, tol_names[mode], tol,
+           steps, failed, t_final, calls, seconds, calls / seconds, error);
+    fflush(stdout);
+}
+
+#define REAL float
+#define SFX _f
+#include "bench_type.h"
+#undef REAL
+#undef SFX
+#define REAL double
+#define SFX _d
+#include "bench_type.h"
+#undef REAL
+#undef SFX
+#define REAL long double
+#define SFX _g
+#include "bench_type.h"
+#undef REAL
+#undef SFX
+
+/* The reference final state, by rkdp54_observe_g at tolerance 1e-16. */
+static void reference(const struct problem *p, long double *ref)
+{
+    long double t_ref;
+    int numfailures;
+    rkab_observer_g obs = {0, 1, &t_ref, ref, NULL, NULL, 0};
+    rkdp54_observe_g(p->u0, p->dim, 100000000, 1e-16L, 0, p->t_end,
+                     get_f_g[p->id], &obs, &numfailures);
+}
+
+/// The fixed-step methods, run for double only.
+#define NUM_FIXED 4
+static const char *fixed_names[] = {"euler", "heun", "rk4", "rk38"};
+
+/* Run fixed-step method m on problem p, writing every state. */
+static void run_fixed(const struct problem *p, const long double *ref, int m)
+{
+    static void (*const methods[])(double*, double*, int, int, double, double,
+                                   void (*)(double, double*, double*)) = {
+        euler, heun, rk4, rk38
+    };
+    const int dim = p->dim, n = p->eulersteps;
+    double *u0 = malloc(dim * sizeof(double));
+    double *u = malloc((size_t)dim * n * sizeof(double));
+    for (int i = 0; i < dim; ++i) {
+        u0[i] = (double)p->u0[i];
+    }
+    double best = 1e300;
+    long calls = 0;
+    for (int r = 0; r < reps_min || (r < reps_max && best * r < time_min);
+         ++r) {
+        numcalls = 0;
+        double start = now();
+        methods[m](u, u0, dim, n, p->t_end / n, 0, get_f_d[p->id]);
+        double seconds = now() - start;
+        best = (seconds < best) ? seconds : best;
+        calls = numcalls;
+    }
+    print_row(p, fixed_names[m], "_d", 0, 0, n, 0, p->t_end, calls, best,
+              max_error_d(dim, &u[(size_t)(n - 1) * dim], ref));
+    free(u0);
+    free(u);
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 1) {
+        brusselator_n = atoi(argv[1]);
+    }
+    static long double u0_sho[] = {0, 1};
+    static long double u0_lorenz[] = {1, 1, 1};
+    static long double u0_arenstorf[] = {
+        0.994L, 0, 0, -2.00158510637908252240537862224L
+    };
+    static long double u0_vdp[] = {2, 0};
+    long double *u0_bruss = malloc(2 * brusselator_n * sizeof(long double));
+    for (int i = 0; i < brusselator_n; ++i) {
+        u0_bruss[2 * i] = 1 + sinl(2 * 3.14159265358979323846L * (i + 1)
+                                   / (brusselator_n + 1));
+        u0_bruss[2 * i + 1] = 3;
+    }
+    struct problem problems[] = {
+        {0, "sho", 2, 50, 1e-6, 1000000, 100000, -1, -1, u0_sho},
+        {1, "lorenz", 3, 10, 1e-6, 1000000, 100000, -1, -1, u0_lorenz},
+        {2, "arenstorf", 4, 17.0652165601579625588917206249, 1e-6, 1000000,
+         100000, -1, -1, u0_arenstorf},
+        {3, "vdp", 2, 20, 1e-6, 1000000, 100000, -1, -1, u0_vdp},
+        {4, "brusselator", 2 * brusselator_n, 10, 1e-6, 100000, 20000, 2, 2,
+         u0_bruss},
+    };
+    const int numproblems = sizeof(problems) / sizeof(*problems);
+
+    printf("problem,dim,method,type,tolerance,tol,steps,failed_steps,t_final,"
+           "f_calls,seconds,f_calls_per_second,error\n");
+    for (int q = 0; q < numproblems; ++q) {
+        const struct problem *p = &problems[q];
+        long double *ref = malloc(p->dim * sizeof(long double));
+        reference(p, ref);
+        for (int m = 0; m < NUM_FIXED; ++m) {
+            run_fixed(p, ref, m);
+        }
+        for (int m = 0; m <= NUM_RK; ++m) {
+            for (int mode = 0; mode < NUM_TOL; ++mode) {
+                run_f(p, ref, m, mode);
+                run_d(p, ref, m, mode);
+                run_g(p, ref, m, mode);
+            }
+        }
+        free(ref);
+    }
+    free(u0_bruss);
+}
@@ -0,0 +1,169 @@
+/** @file
+ * @brief The benchmark problems and runner of bench.c for one data type.
+ * @details Included by bench.c once per type, with REAL defined to the type
+ * and SFX to its symbol suffix (eg., _f), in lieu of templates.
+ * @author Jeremiah O'Neil
+ * @copyright GNU Public License. */
+#define NAME(name) CAT(name, SFX)
+
+static void NAME(get_f_sho)(REAL t, REAL *u, REAL *f)
+{
+    ++numcalls;
+    f[0] = u[1];
+    f[1] = -u[0];
+}
+
+static void NAME(get_f_lorenz)(REAL t, REAL *u, REAL *f)
+{
+    ++numcalls;
+    f[0] = 10 * (u[1] - u[0]);
+    f[1] = u[0] * (28 - u[2]) - u[1];
+    f[2] = u[0] * u[1] - (REAL)8 / 3 * u[2];
+}
+
+static void NAME(get_f_arenstorf)(REAL t, REAL *u, REAL *f)
+{
+    ++numcalls;
+    const REAL m = (REAL)0.012277471L, m1 = 1 - m;
+    const REAL x1 = u[0] + m, x2 = u[0] - m1;
+    const REAL d1 = x1 * x1 + u[1] * u[1], d2 = x2 * x2 + u[1] * u[1];
+    const REAL r1 = d1 * sqrt(d1), r2 = d2 * sqrt(d2);
+    f[0] = u[2];
+    f[1] = u[3];
+    f[2] = u[0] + 2 * u[3] - m1 * x1 / r1 - m * x2 / r2;
+    f[3] = u[1] - 2 * u[2] - m1 * u[1] / r1 - m * u[1] / r2;
+}
+
+static void NAME(get_f_vdp)(REAL t, REAL *u, REAL *f)
+{
+    ++numcalls;
+    f[0] = u[1];
+    f[1] = 5 * (1 - u[0] * u[0]) * u[1] - u[0];
+}
+
+/* Brusselator with diffusion on [0, 1], (u, v) interleaved so that the
+ * Jacobian is banded with ml = mu = 2. */
+static void NAME(get_f_brusselator)(REAL t, REAL *u, REAL *f)
+{
+    ++numcalls;
+    const int n = brusselator_n;
+    const REAL c = (REAL)(n + 1) * (n + 1) / 50;
+    for (int i = 0; i < n; ++i) {
+        const REAL ui = u[2 * i], vi = u[2 * i + 1];
+        const REAL ul = i ? u[2 * i - 2] : 1, ur = i < n - 1 ? u[2 * i + 2] : 1;
+        const REAL vl = i ? u[2 * i - 1] : 3, vr = i < n - 1 ? u[2 * i + 3] : 3;
+        f[2 * i] = 1 + ui * ui * vi - 4 * ui + c * (ul - 2 * ui + ur);
+        f[2 * i + 1] = 3 * ui - ui * ui * vi + c * (vl - 2 * vi + vr);
+    }
+}
+
+static void (*NAME(get_f)[])(REAL, REAL*, REAL*) = {
+    NAME(get_f_sho), NAME(get_f_lorenz), NAME(get_f_arenstorf),
+    NAME(get_f_vdp), NAME(get_f_brusselator)
+};
+
+/* The largest absolute error of u against the reference. */
+static double NAME(max_error)(int dim, const REAL *u, const long double *ref)
+{
+    long double err = 0;
+    for (int i = 0; i < dim; ++i) {
+        long double e = fabsl((long double)u[i] - ref[i]);
+        err = (e > err || e != e) ? e : err; // propagate NaN
+    }
+    return (double)err;
+}
+
+typedef NAME(results_rkab) *(*NAME(method))(REAL*, int, int, REAL,
+                                                  REAL, REAL,
+                                                  void (*)(REAL, REAL*, REAL*));
+typedef NAME(results_rkab) *(*NAME(method_arrtol))(REAL*, int, int,
+                                                        REAL*, REAL, REAL,
+                                                        void (*)(REAL, REAL*,
+                                                                 REAL*));
+typedef NAME(results_rkab) *(*NAME(method_opt))(REAL*, int, int,
+                                                     const NAME(rkab_options)*,
+                                                     REAL, REAL,
+                                                     void (*)(REAL, REAL*,
+                                                              REAL*));
+
+/* Run method m of the adaptive methods (the last is ros23) on problem p,
+ * in tolerance mode 'mode' (see tol_names), and print a row. */
+static void NAME(run)(const struct problem *p, const long double *ref, int m,
+                      int mode)
+{
+    static const NAME(method) methods[] = {
+        CAT(rk12, SFX), CAT(rk23, SFX), CAT(rk45, SFX),
+        CAT(rkbs32, SFX), CAT(rkdp54, SFX)
+    };
+    static const NAME(method_arrtol) methods_arrtol[] = {
+        CAT(rk12_arrtol, SFX), CAT(rk23_arrtol, SFX), CAT(rk45_arrtol, SFX),
+        CAT(rkbs32_arrtol, SFX), CAT(rkdp54_arrtol, SFX)
+    };
+    static const NAME(method_opt) methods_opt[] = {
+        CAT(rk12_opt, SFX), CAT(rk23_opt, SFX), CAT(rk45_opt, SFX),
+        CAT(rkbs32_opt, SFX), CAT(rkdp54_opt, SFX)
+    };
+    const int dim = p->dim;
+    const REAL tol = (sizeof(REAL) < sizeof(double)) ? 10 * p->tol : p->tol;
+    REAL *u0 = malloc(dim * sizeof(REAL));
+    REAL *tols = malloc(dim * sizeof(REAL));
+    for (int i = 0; i < dim; ++i) {
+        u0[i] = (REAL)p->u0[i];
+        tols[i] = tol;
+    }
+    // Absolute and relative tolerance alike, PI control
+    const NAME(rkab_options) opts = {tol, tol, NULL, NULL, RKAB_NORM_RMS,
+                                     RKAB_CONTROL_PI, 0};
+
+    NAME(results_rkab) *res = NULL;
+    double best = 1e300;
+    long calls = 0;
+    for (int r = 0; r < reps_min || (r < reps_max && best * r < time_min);
+         ++r) {
+        if (res) {
+            CAT(delete_results_rkab, SFX)(res);
+        }
+        numcalls = 0;
+        double start = now();
+        if (m == NUM_RK && mode == TOL_OPT) {
+            res = CAT(ros23_opt, SFX)(u0, dim, p->maxsteps, &opts, 0,
+                                      (REAL)p->t_end, NAME(get_f)[p->id],
+                                      NULL, p->ml, p->mu);
+        } else if (m == NUM_RK && mode == TOL_ARRAY) {
+            res = CAT(ros23_arrtol, SFX)(u0, dim, p->maxsteps, tols, 0,
+                                         (REAL)p->t_end, NAME(get_f)[p->id],
+                                         NULL, p->ml, p->mu);
+        } else if (m == NUM_RK) {
+            res = CAT(ros23, SFX)(u0, dim, p->maxsteps, tol, 0,
+                                  (REAL)p->t_end, NAME(get_f)[p->id],
+                                  NULL, p->ml, p->mu);
+        } else if (mode == TOL_OPT) {
+            res = methods_opt[m](u0, dim, p->maxsteps, &opts, 0,
+                                 (REAL)p->t_end, NAME(get_f)[p->id]);
+        } else if (mode == TOL_ARRAY) {
+            res = methods_arrtol[m](u0, dim, p->maxsteps, tols, 0,
+                                    (REAL)p->t_end, NAME(get_f)[p->id]);
+        } else {
+            res = methods[m](u0, dim, p->maxsteps, tol, 0, (REAL)p->t_end,
+                             NAME(get_f)[p->id]);
+        }
+        double seconds = now() - start;
+        if (seconds < best) {
+            best = seconds;
+        }
+        calls = numcalls;
+    }
+
+    const int last = res->numsteps - 1;
+    const REAL t_final = (last >= 0) ? res->t[last] : 0;
+    const REAL *u_final = (last >= 0) ? &res->u[last * dim] : u0;
+    print_row(p, method_names[m], STR(SFX), mode, (double)tol,
+              res->numsteps, res->numfailures, (long double)t_final, calls,
+              best, NAME(max_error)(dim, u_final, ref));
+
+    CAT(delete_results_rkab, SFX)(res);
+    free(u0);
+    free(tols);
+}
+
+#undef NAME
@@ -0,0 +1,76 @@
+/** @file
+ * @brief Benchmark of repeated small solves with and without a context.
+ * @details Solves a short stretch of the Lorenz system (dim 3) from many
+ * initial states, once with the one-shot rk45_d and once with rk45_solve_d in
+ * one rkab_context, and prints the time and the number of heap allocations
+ * per solve of each. Allocations are counted by wrapping malloc (glibc).
+ * Usage: context [numsolves [t_end]]
+ * @author Jeremiah O'Neil
+ * @copyright GNU Public License. */
+#include "../adaptive_step_rk.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static long nummallocs;
+
+/* Count every allocation, including those of operator new in the library. */
+extern void *__libc_malloc(size_t size);
+void *malloc(size_t size)
+{
+    ++nummallocs;
+    return __libc_malloc(size);
+}
+
+static void get_f_lorenz(double t, double *u, double *f)
+{
+    f[0] = 10 * (u[1] - u[0]);
+    f[1] = u[0] * (28 - u[2]) - u[1];
+    f[2] = u[0] * u[1] - 8. / 3 * u[2];
+}
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+int main(int argc, char **argv)
+{
+    int num = (argc > 1) ? atoi(argv[1]) : 1000000;
+    double t_end = (argc > 2) ? atof(argv[2]) : 0.1;
+    double u0[3], check = 0;
+
+    double start = now();
+    long allocs = nummallocs;
+    for (int n = 0; n < num; ++n) {
+        u0[0] = 1 + 1e-6 * n; u0[1] = 1; u0[2] = 1;
+        results_rkab_d *res = rk45_d(u0, 3, 10000, 1e-6, 0, t_end,
+                                     get_f_lorenz);
+        check += res->u[3 * (res->numsteps - 1)];
+        delete_results_rkab_d(res);
+    }
+    double oneshot = (now() - start) / num;
+    double oneshot_allocs = (double)(nummallocs - allocs) / num;
+
+    rkab_context_d *ctx = rkab_context_create_d(3, 64);
+    start = now();
+    allocs = nummallocs;
+    for (int n = 0; n < num; ++n) {
+        u0[0] = 1 + 1e-6 * n; u0[1] = 1; u0[2] = 1;
+        const results_rkab_d *res = rk45_solve_d(ctx, u0, 10000, 1e-6, 0,
+                                                 t_end, get_f_lorenz);
+        check -= res->u[3 * (res->numsteps - 1)];
+    }
+    double context = (now() - start) / num;
+    long context_allocs = nummallocs - allocs;
+    rkab_context_destroy_d(ctx);
+
+    printf("%d solves of dim 3 on [0, %g]\n", num, t_end);
+    printf("one-shot: %8.3f us/solve, %5.2f allocations/solve\n",
+           1e6 * oneshot, oneshot_allocs);
+    printf("context:  %8.3f us/solve, %5.2f allocations/solve (%ld in all)\n",
+           1e6 * context, (double)context_allocs / num, context_allocs);
+    printf("(checksum %g)\n", check);
+}
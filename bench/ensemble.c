@@ -0,0 +1,72 @@
+/** @file
+ * @brief Scaling benchmark of the multithreaded ensemble solver.
+ * @details Solves an ensemble of Van der Pol oscillators whose stiffness, and
+ * so whose cost, varies by orders of magnitude across the ensemble with
+ * rk45_ensemble_d on 1, 2, 4, ... threads up to the number given (default:
+ * the number of online processors), and prints the throughput and speedup
+ * over one thread for each.
+ * Usage: ensemble [maxthreads [numproblems]]
+ * @author Jeremiah O'Neil
+ * @copyright GNU Public License. */
+#include "../adaptive_step_rk.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+/* Van der Pol oscillator; the parameter mu rides along as a constant third
+ * component, so each problem of the ensemble can have its own. */
+static void get_f_vdp(double t, double *u, double *f)
+{
+    f[0] = u[1];
+    f[1] = u[2] * (1 - u[0] * u[0]) * u[1] - u[0];
+    f[2] = 0;
+}
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+int main(int argc, char **argv)
+{
+    int maxthreads = (argc > 1) ? atoi(argv[1]) : sysconf(_SC_NPROCESSORS_ONLN);
+    int num = (argc > 2) ? atoi(argv[2]) : 2000;
+    int dim = 3;
+    double *u0 = malloc(num * dim * sizeof(double));
+    double *tol = malloc(num * sizeof(double));
+    double *t = malloc(num * sizeof(double));
+    double *t_end = malloc(num * sizeof(double));
+    for (int p = 0; p < num; ++p) {
+        u0[p * dim] = 2;
+        u0[p * dim + 1] = 0;
+        u0[p * dim + 2] = 0.1 + 30.0 * (p % 97) / 96; // mu, mixed in order
+        tol[p] = 1e-8;
+        t[p] = 0;
+        t_end[p] = 20;
+    }
+
+    printf("threads,seconds,problems_per_second,speedup,efficiency\n");
+    double base = 0;
+    for (int threads = 1; threads <= maxthreads; threads *= 2) {
+        double start = now();
+        results_rkab_d **res = rk45_ensemble_d(u0, dim, num, 1000000, tol,
+                                               t, t_end, get_f_vdp, threads);
+        double seconds = now() - start;
+        delete_results_rkab_array_d(res, num);
+        if (threads == 1) {
+            base = seconds;
+        }
+        printf("%d,%.4f,%.1f,%.2f,%.2f\n", threads, seconds, num / seconds,
+               base / seconds, base / seconds / threads);
+        if (threads < maxthreads && threads * 2 > maxthreads) {
+            threads = maxthreads / 2; // finish on maxthreads itself
+        }
+    }
+    free(u0);
+    free(tol);
+    free(t);
+    free(t_end);
+}
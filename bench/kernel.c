@@ -0,0 +1,81 @@
+/** @file
+ * @brief Microbenchmark of the stage arithmetic of the rkab solvers.
+ * @details Solves a system of uncoupled harmonic oscillators, whose
+ * derivative costs next to nothing, so that the time goes to the solver's own
+ * arithmetic, at dimensions 10, 1e3 and 1e6 (or those given). Keeps only the
+ * final state, through the observing solvers, and prints the time per
+ * attempted step and per state element.
+ * Usage: kernel [dim...]
+ * @author Jeremiah O'Neil
+ * @copyright GNU Public License. */
+#include "../adaptive_step_rk.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/* Uncoupled harmonic oscillators, in (position, velocity) pairs. */
+static int dim_sho;
+static void get_f_sho(double t, double *u, double *f)
+{
+    for (int i = 0; i < dim_sho; i += 2) {
+        f[i] = u[i + 1];
+        f[i + 1] = -u[i];
+    }
+}
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+typedef int (*observe_method)(double *, int, int, double, double, double,
+                              void (*)(double, double *, double *),
+                              rkab_observer_d *, int *);
+
+int main(int argc, char **argv)
+{
+    int dims[16] = {10, 1000, 1000000};
+    int numdims = 3;
+    if (argc > 1) {
+        numdims = (argc - 1 < 16) ? argc - 1 : 16;
+        for (int d = 0; d < numdims; ++d) {
+            dims[d] = atoi(argv[d + 1]) / 2 * 2;
+        }
+    }
+    const char *names[] = {"rk45", "rkdp54", "rk23"};
+    observe_method methods[] = {rk45_observe_d, rkdp54_observe_d,
+                                rk23_observe_d};
+
+    printf("method,dim,reps,steps,ns_per_step,ns_per_step_element\n");
+    for (int d = 0; d < numdims; ++d) {
+        int dim = dims[d];
+        int reps = (dim < 100000) ? 100000 / dim : 1;
+        double t_end = (dim < 100000) ? 50 : 5;
+        double *u0 = malloc(dim * sizeof(double));
+        double *u = malloc(dim * sizeof(double));
+        for (int i = 0; i < dim; i += 2) {
+            u0[i] = 0;
+            u0[i + 1] = 1 + (double)i / dim;
+        }
+        dim_sho = dim;
+        for (int m = 0; m < 3; ++m) {
+            double t_obs;
+            rkab_observer_d obs = {0, 1, &t_obs, u, NULL, NULL, 0};
+            long steps = 0;
+            double start = now();
+            for (int r = 0; r < reps; ++r) {
+                int numfailures;
+                steps += methods[m](u0, dim, 100000000, 1e-7, 0, t_end,
+                                    get_f_sho, &obs, &numfailures);
+                steps += numfailures;
+            }
+            double ns = 1e9 * (now() - start) / steps;
+            printf("%s,%d,%d,%ld,%.1f,%.3f\n", names[m], dim, reps, steps,
+                   ns, ns / dim);
+        }
+        free(u0);
+        free(u);
+    }
+}
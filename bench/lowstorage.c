@@ -0,0 +1,92 @@
+/** @file
+ * @brief Memory and throughput benchmark of the low-storage solver.
+ * @details Solves ten million (or as many as given) uncoupled harmonic
+ * oscillators, whose derivative costs next to nothing, with the observing
+ * solvers of rkls43, rk45 and rkdp54, keeping only the final state, each in a
+ * process of its own. Prints for each the steps and those where a failure
+ * occured, the time per step and per step and element (bound by memory
+ * bandwidth), the memory high-water mark of the process and that less the
+ * initial and final states, which leaves the solver's scratch memory, and
+ * the error of the final state.
+ * Usage: lowstorage [dim]
+ * @author Jeremiah O'Neil
+ * @copyright GNU Public License. */
+#include "../adaptive_step_rk.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+/* Uncoupled harmonic oscillators, in (position, velocity) pairs. */
+static int dim_sho;
+static void get_f_sho(double t, double *u, double *f)
+{
+    for (int i = 0; i < dim_sho; i += 2) {
+        f[i] = u[i + 1];
+        f[i + 1] = -u[i];
+    }
+}
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+typedef int (*method)(double *, int, int, double, double, double,
+                      void (*)(double, double *, double *),
+                      rkab_observer_d *, int *);
+
+/* Solve with method m and print a row; run in a process of its own. */
+static void run(const char *name, method m, int dim)
+{
+    const double t_end = 1;
+    double *u0 = malloc(dim * sizeof(double));
+    for (int i = 0; i < dim; i += 2) {
+        u0[i] = 0; // sin(t)
+        u0[i + 1] = 1; // cos(t)
+    }
+    double *u = malloc(dim * sizeof(double));
+    double t_last;
+    rkab_observer_d obs = {0, 1, &t_last, u, NULL, NULL, 0};
+    int numfailures;
+    double start = now();
+    int numsteps = m(u0, dim, 1000, 1e-6, 0, t_end, get_f_sho, &obs,
+                     &numfailures);
+    double seconds = now() - start;
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    const double mb = 1 << 20;
+    double peak = usage.ru_maxrss * 1024. / mb; // ru_maxrss is in KiB
+    double held = (2. * dim * sizeof(double)) / mb;
+    double err = fmax(fabs(u[0] - sin(t_end)), fabs(u[1] - cos(t_end)));
+    printf("%s,%d,%d,%d,%.4f,%.2f,%.0f,%.0f,%.3e\n", name, dim,
+           numsteps, numfailures, seconds / numsteps,
+           1e9 * seconds / numsteps / dim, peak, peak - held, err);
+    fflush(stdout);
+    free(u0);
+    free(u);
+}
+
+int main(int argc, char **argv)
+{
+    dim_sho = (argc > 1) ? atoi(argv[1]) / 2 * 2 : 10000000;
+    const char *names[] = {"rkls43", "rk45", "rkdp54"};
+    method methods[] = {rkls43_observe_d, rk45_observe_d, rkdp54_observe_d};
+
+    printf("method,dim,steps,failed_steps,seconds_per_step,"
+           "ns_per_step_element,peak_mb,scratch_mb,error\n");
+    fflush(stdout);
+    for (int m = 0; m < 3; ++m) {
+        pid_t pid = fork(); // so each high-water mark is its own
+        if (pid == 0) {
+            run(names[m], methods[m], dim_sho);
+            return 0;
+        }
+        waitpid(pid, NULL, 0);
+    }
+}
@@ -0,0 +1,148 @@
+/** @file
+ * @brief Benchmark of the mixed-precision solvers.
+ * @details Solves harmonic oscillators with known solutions by rk45_f,
+ * rk45_d and rk45_fd (float stages, double state) and prints for each the
+ * steps taken and those where a failure occured, the time per step, and the
+ * largest error of the final state. The long run shows the drift of float
+ * in the state and parameter; the wide one, the throughput of float stages.
+ * Usage: mixed [tol]
+ * @author Jeremiah O'Neil
+ * @copyright GNU Public License. */
+#include "../adaptive_step_rk.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define DIM_WIDE 20000 // the wide problem: DIM_WIDE / 2 oscillators
+
+/* Oscillator i, of the structure-of-arrays state (x, v), has frequency w_i. */
+static double omega(int i, int n)
+{
+    return 1 + (double)i / n;
+}
+
+#define GET_F_OSC(sfx, T)                                      \
+    static void get_f_osc##sfx(T t, T *u, T *f)                \
+    {                                                          \
+        f[0] = u[1];                                           \
+        f[1] = -u[0];                                          \
+    }                                                          \
+    static void get_f_wide##sfx(T t, T *u, T *f)               \
+    {                                                          \
+        const int n = DIM_WIDE / 2;                            \
+        for (int i = 0; i < n; ++i) {                          \
+            const T w = (T)omega(i, n);                        \
+            f[i] = u[n + i];                                   \
+            f[n + i] = -w * w * u[i];                          \
+        }                                                      \
+    }
+GET_F_OSC(_f, float)
+GET_F_OSC(_d, double)
+
+struct problem
+{
+    const char *name;
+    int dim;
+    double t_end;
+    int maxsteps; // bounds the memory of the trajectory
+};
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+/* The initial state: every oscillator at x = 0, v = 1. */
+static void initial(double *u, int dim)
+{
+    for (int i = 0; i < dim; ++i) {
+        u[i] = (i < dim / 2) ? 0 : 1;
+    }
+}
+
+/* The largest error of a final state u at t against the exact solution. */
+static double error(const double *u, int dim, double t)
+{
+    const int n = dim / 2;
+    double err = 0;
+    for (int i = 0; i < n; ++i) {
+        const double w = (dim == 2) ? 1 : omega(i, n);
+        const double e = fmax(fabs(u[i] - sin(w * t) / w),
+                              fabs(u[n + i] - cos(w * t)));
+        err = (e > err || e != e) ? e : err; // propagate NaN
+    }
+    return err;
+}
+
+static void report(const char *name, const char *method, int dim, double t,
+                   int numsteps, int numfailures, double seconds,
+                   const double *u)
+{
+    printf("%s,%s,%d,%d,%.3e,%.4e,%.3e\n", name, method, numsteps,
+           numfailures, seconds, seconds / numsteps, error(u, dim, t));
+}
+
+int main(int argc, char **argv)
+{
+    const double tol = (argc > 1) ? atof(argv[1]) : 1e-5;
+    const struct problem problems[] = {
+        {"long", 2, 1e5, 10000000},
+        {"wide", DIM_WIDE, 20, 10000},
+    };
+    const int numproblems = sizeof(problems) / sizeof(*problems);
+
+    printf("problem,method,steps,failed_steps,seconds,seconds_per_step,"
+           "error\n");
+    for (int q = 0; q < numproblems; ++q) {
+        const struct problem *p = &problems[q];
+        const int dim = p->dim;
+        void (*get_f_f)(float, float*, float*) =
+            (dim == 2) ? get_f_osc_f : get_f_wide_f;
+        void (*get_f_d)(double, double*, double*) =
+            (dim == 2) ? get_f_osc_d : get_f_wide_d;
+        double *u0 = malloc(dim * sizeof(double));
+        float *u0_f = malloc(dim * sizeof(float));
+        double *u_end = malloc(dim * sizeof(double));
+        initial(u0, dim);
+        for (int i = 0; i < dim; ++i) {
+            u0_f[i] = (float)u0[i];
+        }
+
+        double start = now();
+        results_rkab_f *res_f = rk45_f(u0_f, dim, p->maxsteps, (float)tol, 0,
+                                       (float)p->t_end, get_f_f);
+        double seconds = now() - start;
+        int last = res_f->numsteps - 1;
+        for (int i = 0; i < dim; ++i) {
+            u_end[i] = res_f->u[(size_t)last * dim + i];
+        }
+        report(p->name, "rk45_f", dim, res_f->t[last], res_f->numsteps,
+               res_f->numfailures, seconds, u_end);
+        delete_results_rkab_f(res_f);
+
+        start = now();
+        results_rkab_d *res_d = rk45_d(u0, dim, p->maxsteps, tol, 0, p->t_end,
+                                       get_f_d);
+        seconds = now() - start;
+        last = res_d->numsteps - 1;
+        report(p->name, "rk45_d", dim, res_d->t[last], res_d->numsteps,
+               res_d->numfailures, seconds, &res_d->u[(size_t)last * dim]);
+        delete_results_rkab_d(res_d);
+
+        start = now();
+        results_rkab_d *res_fd = rk45_fd(u0, dim, p->maxsteps, tol, 0, p->t_end,
+                                         get_f_f);
+        seconds = now() - start;
+        last = res_fd->numsteps - 1;
+        report(p->name, "rk45_fd", dim, res_fd->t[last], res_fd->numsteps,
+               res_fd->numfailures, seconds, &res_fd->u[(size_t)last * dim]);
+        delete_results_rkab_d(res_fd);
+
+        free(u0);
+        free(u0_f);
+        free(u_end);
+    }
+}
@@ -0,0 +1,115 @@
+/** @file
+ * @brief Benchmark of the multirate solvers on well-separated time scales.
+ * @details Solves a fast oscillator, of angular frequency 100 (or as given),
+ * driven by the first of a thousand slow oscillators (or as many as given)
+ * of frequency near 1, which it drives weakly in turn (the slow ones swing
+ * about 2, so that their relative error doesn't blow up at zero), with
+ * rk45_d and rkdp54_d on the whole system and with rk45_multirate_d and
+ * rkdp54_multirate_d. Prints for each the steps (of the whole system) and
+ * those where a failure occured, the evaluations of each partition's
+ * derivative, the time, and the error of the final state against a solve
+ * with rkdp54_d to tolerance 1e-12.
+ * Usage: multirate [slow oscillators [frequency]]
+ * @author Jeremiah O'Neil
+ * @copyright GNU Public License. */
+#include "../adaptive_step_rk.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/* Two fast components (a fast oscillator) then pairs of slow ones. */
+static int dim_mr;
+static double omega = 100;
+static long calls_fast, calls_slow;
+static void get_f_fast(double t, double *u, double *f)
+{
+    ++calls_fast;
+    f[0] = omega * u[1] + u[2] - 2;
+    f[1] = -omega * u[0];
+}
+static void get_f_slow(double t, double *u, double *f)
+{
+    ++calls_slow;
+    for (int i = 2; i < dim_mr; i += 2) {
+        const double w = 1 + 0.5 * i / dim_mr;
+        f[i] = w * (u[i + 1] - 2);
+        f[i + 1] = -w * (u[i] - 2) + 0.01 * u[0];
+    }
+}
+static void get_f_whole(double t, double *u, double *f)
+{
+    get_f_fast(t, u, f);
+    get_f_slow(t, u, f);
+}
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+typedef results_rkab_d *(*method)(double *, int, int, double, double, double,
+                                  void (*)(double, double *, double *));
+typedef results_rkab_d *(*method_mr)(double *, int, int, int, double, double,
+                                     double,
+                                     void (*)(double, double *, double *),
+                                     void (*)(double, double *, double *));
+
+/* Print a row for a solution, freeing it. */
+static void report(const char *name, results_rkab_d *res, double seconds,
+                   const double *ref)
+{
+    const double *u = &res->u[(size_t)(res->numsteps - 1) * dim_mr];
+    double err = 0;
+    for (int i = 0; i < dim_mr; ++i) {
+        err = fmax(err, fabs(u[i] - ref[i]));
+    }
+    printf("%s,%d,%d,%ld,%ld,%.4f,%.3e\n", name, res->numsteps,
+           res->numfailures, calls_fast, calls_slow, seconds, err);
+    delete_results_rkab_d(res);
+}
+
+int main(int argc, char **argv)
+{
+    dim_mr = 2 + 2 * ((argc > 1) ? atoi(argv[1]) : 1000);
+    omega = (argc > 2) ? atof(argv[2]) : 100;
+    const int maxsteps = 10000000;
+    const double tol = 1e-6, t_end = 10;
+    double *u0 = malloc(dim_mr * sizeof(double));
+    for (int i = 0; i < dim_mr; i += 2) {
+        u0[i] = (i > 0) ? 2 : 0;
+        u0[i + 1] = (i > 0) ? 3 : 1;
+    }
+
+    results_rkab_d *res = rkdp54_d(u0, dim_mr, maxsteps, 1e-12, 0, t_end,
+                                   get_f_whole);
+    double *ref = malloc(dim_mr * sizeof(double));
+    const double *u_ref = &res->u[(size_t)(res->numsteps - 1) * dim_mr];
+    for (int i = 0; i < dim_mr; ++i) {
+        ref[i] = u_ref[i];
+    }
+    delete_results_rkab_d(res);
+
+    const char *names[] = {"rk45", "rkdp54"};
+    method methods[] = {rk45_d, rkdp54_d};
+    method_mr multirate[] = {rk45_multirate_d, rkdp54_multirate_d};
+    printf("method,steps,failed_steps,fast_calls,slow_calls,seconds,error\n");
+    for (int m = 0; m < 2; ++m) {
+        char name[32];
+        calls_fast = calls_slow = 0;
+        double start = now();
+        res = methods[m](u0, dim_mr, maxsteps, tol, 0, t_end, get_f_whole);
+        report(names[m], res, now() - start, ref);
+
+        snprintf(name, sizeof(name), "%s_multirate", names[m]);
+        calls_fast = calls_slow = 0;
+        start = now();
+        res = multirate[m](u0, dim_mr, 2, maxsteps, tol, 0, t_end,
+                           get_f_fast, get_f_slow);
+        report(name, res, now() - start, ref);
+    }
+    free(u0);
+    free(ref);
+}
@@ -0,0 +1,86 @@
+/** @file
+ * @brief Scaling benchmark of the solvers parallel within each step.
+ * @details Solves a periodic reaction-diffusion system discretized on a
+ * million points (or as many as given) with rk45_observe_d, and with
+ * rk45_parallel_d on 1, 2, 4, ... threads up to the number given (default:
+ * the number of online processors), both with the derivative evaluated as a
+ * whole and by range. Prints for each the time, the speedup over
+ * rk45_observe_d, and whether the final state is identical to its own.
+ * Usage: parallel [dim [maxthreads]]
+ * @author Jeremiah O'Neil
+ * @copyright GNU Public License. */
+#include "../adaptive_step_rk.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/* u_t = u_xx / 4 + u (1 - u) / 100 on a periodic grid of unit spacing. */
+static int dim_rd;
+static void get_f_rd_range(double t, double *u, double *f, int begin, int end)
+{
+    for (int i = begin; i < end; ++i) {
+        const double l = u[(i > 0) ? i - 1 : dim_rd - 1];
+        const double r = u[(i < dim_rd - 1) ? i + 1 : 0];
+        f[i] = 0.25 * (l - 2 * u[i] + r) + 0.01 * u[i] * (1 - u[i]);
+    }
+}
+static void get_f_rd(double t, double *u, double *f)
+{
+    get_f_rd_range(t, u, f, 0, dim_rd);
+}
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+int main(int argc, char **argv)
+{
+    dim_rd = (argc > 1) ? atoi(argv[1]) : 1000000;
+    int maxthreads = (argc > 2) ? atoi(argv[2]) : sysconf(_SC_NPROCESSORS_ONLN);
+    const int maxsteps = 1000000;
+    const double tol = 1e-6, t_end = 400;
+    double *u0 = malloc(dim_rd * sizeof(double));
+    double *u_seq = malloc(dim_rd * sizeof(double));
+    double *u = malloc(dim_rd * sizeof(double));
+    for (int i = 0; i < dim_rd; ++i) {
+        u0[i] = 0.5 + 0.25 * sin(6.283185307179586 * 64 * i / dim_rd)
+                    + 0.125 * sin(0.5 * i);
+    }
+    double t_last;
+    rkab_observer_d obs = {0, 1, &t_last, u_seq, NULL, NULL, 0};
+
+    printf("method,threads,steps,seconds,speedup,identical\n");
+    int numfailures;
+    double start = now();
+    int numsteps = rk45_observe_d(u0, dim_rd, maxsteps, tol, 0, t_end,
+                                  get_f_rd, &obs, &numfailures);
+    double base = now() - start;
+    printf("observe,1,%d,%.4f,1.00,1\n", numsteps, base);
+
+    obs.u = u;
+    for (int range = 0; range <= 1; ++range) {
+        for (int threads = 1; threads <= maxthreads; threads *= 2) {
+            start = now();
+            numsteps = rk45_parallel_d(u0, dim_rd, maxsteps, tol, 0, t_end,
+                                       range ? NULL : get_f_rd,
+                                       range ? get_f_rd_range : NULL,
+                                       threads, &obs, &numfailures);
+            double seconds = now() - start;
+            int same = !memcmp(u, u_seq, dim_rd * sizeof(double));
+            printf("%s,%d,%d,%.4f,%.2f,%d\n", range ? "range" : "whole",
+                   threads, numsteps, seconds, base / seconds, same);
+            if (threads < maxthreads && threads * 2 > maxthreads) {
+                threads = maxthreads / 2; // finish on maxthreads itself
+            }
+        }
+    }
+    free(u0);
+    free(u_seq);
+    free(u);
+}
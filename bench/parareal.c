@@ -0,0 +1,126 @@
+/** @file
+ * @brief Scaling benchmark of the parallel-in-time solver.
+ * @details Solves single long trajectories of the benchmark problems with
+ * rk45_parareal_d on 1, 2, 4, ... threads up to the number given (default:
+ * the number of online processors), one or more slices per thread, and prints
+ * for each the iterations taken, the speedup over a sequential rk45_d solve,
+ * the speedup bound slices / iterations (which the measured speedup
+ * approaches given enough cores and a cheap coarse propagator), and the
+ * error of the final state against that of the sequential solve.
+ * Usage: parareal [maxthreads [slices_per_thread]]
+ * @author Jeremiah O'Neil
+ * @copyright GNU Public License. */
+#include "../adaptive_step_rk.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+static void get_f_sho(double t, double *u, double *f)
+{
+    f[0] = u[1];
+    f[1] = -u[0];
+}
+
+static void get_f_vdp(double t, double *u, double *f)
+{
+    f[0] = u[1];
+    f[1] = 5 * (1 - u[0] * u[0]) * u[1] - u[0];
+}
+
+static void get_f_arenstorf(double t, double *u, double *f)
+{
+    const double m = 0.012277471, m1 = 1 - m;
+    const double x1 = u[0] + m, x2 = u[0] - m1;
+    const double d1 = x1 * x1 + u[1] * u[1], d2 = x2 * x2 + u[1] * u[1];
+    const double r1 = d1 * sqrt(d1), r2 = d2 * sqrt(d2);
+    f[0] = u[2];
+    f[1] = u[3];
+    f[2] = u[0] + 2 * u[3] - m1 * x1 / r1 - m * x2 / r2;
+    f[3] = u[1] - 2 * u[2] - m1 * u[1] / r1 - m * u[1] / r2;
+}
+
+static void get_f_lorenz(double t, double *u, double *f)
+{
+    f[0] = 10 * (u[1] - u[0]);
+    f[1] = u[0] * (28 - u[2]) - u[1];
+    f[2] = u[0] * u[1] - 8.0 / 3 * u[2];
+}
+
+struct problem
+{
+    const char *name;
+    int dim;
+    double t_end;
+    int coarsesteps; // over the whole domain, split among the slices
+    void (*get_f)(double, double*, double*);
+    double u0[4];
+};
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+/* The final state of a solution, or NULL if it took no steps. */
+static const double *final(const results_rkab_d *r, int dim)
+{
+    return r->numsteps ? &r->u[(r->numsteps - 1) * dim] : NULL;
+}
+
+int main(int argc, char **argv)
+{
+    int maxthreads = (argc > 1) ? atoi(argv[1]) : sysconf(_SC_NPROCESSORS_ONLN);
+    int per_thread = (argc > 2) ? atoi(argv[2]) : 1;
+    const double tol = 1e-10, ptol = 1e-8;
+    const struct problem problems[] = {
+        {"sho", 2, 2000, 4000, get_f_sho, {0, 1}},
+        {"vdp", 2, 200, 4000, get_f_vdp, {2, 0}},
+        {"arenstorf", 4, 17.0652165601579625588917206249, 2000,
+         get_f_arenstorf, {0.994, 0, 0, -2.00158510637908252240537862224}},
+        {"lorenz", 3, 20, 2000, get_f_lorenz, {1, 1, 1}},
+    };
+    const int numproblems = sizeof(problems) / sizeof(*problems);
+
+    printf("problem,threads,slices,iterations,seconds,speedup,bound,error\n");
+    for (int q = 0; q < numproblems; ++q) {
+        const struct problem *p = &problems[q];
+        double *u0 = (double *)p->u0;
+        double start = now();
+        results_rkab_d *seq = rk45_d(u0, p->dim, 100000000, tol, 0,
+                                     p->t_end, p->get_f);
+        double base = now() - start;
+        const double *u_seq = final(seq, p->dim);
+        printf("%s,0,1,1,%.4f,1.00,1.00,0\n", p->name, base);
+        for (int threads = 1; threads <= maxthreads; threads *= 2) {
+            const int slices = threads * per_thread;
+            // The same coarse step size however many slices
+            rkab_parareal_options_d opts = {
+                slices, (p->coarsesteps + slices - 1) / slices, ptol, 0,
+                threads, 0
+            };
+            start = now();
+            results_rkab_d *res = rk45_parareal_d(u0, p->dim, 100000000, tol,
+                                                  0, p->t_end, p->get_f,
+                                                  &opts);
+            double seconds = now() - start;
+            const double *u = final(res, p->dim);
+            double err = 0;
+            for (int i = 0; i < p->dim; ++i) {
+                double e = fabs(u[i] - u_seq[i]);
+                err = (e > err || e != e) ? e : err; // propagate NaN
+            }
+            printf("%s,%d,%d,%d,%.4f,%.2f,%.2f,%.3e\n", p->name, threads,
+                   slices, opts.numiter, seconds, base / seconds,
+                   (double)slices / opts.numiter, err);
+            delete_results_rkab_d(res);
+            if (threads < maxthreads && threads * 2 > maxthreads) {
+                threads = maxthreads / 2; // finish on maxthreads itself
+            }
+        }
+        delete_results_rkab_d(seq);
+    }
+}
@@ -1,15 +1,62 @@
-/** @file 
- * @brief Euler method interface header
+/** @file
+ * @brief Fixed step size Runge-Kutta interface
+ * @details As adaptive_step_rk.h, for the fixed step size methods of
+ * rkfixed.hpp: included at library compile-time by rkfixed.cpp to produce
+ * the C-compatible interface, and at program compile-time by C to define it.
+ * The methods are the Euler method (euler), Heun's method (heun), the
+ * classical Runge-Kutta method (rk4) and the 3/8-rule Runge-Kutta method
+ * (rk38), each exported for every target of MAP_TARGETS_TO() and with the
+ * suffix _stride taking an output stride.
  * @author Jeremiah O'Neil
  * @copyright GNU Public License. */
 #ifndef INC_EULER_h // #include guard
 #define INC_EULER_h // ensure this file is only included once
 
 #include <stdlib.h>
+#include "adaptive_step_rk.h" // MAP_TARGETS_TO
 
 typedef void (*derivative_function)(double t_n, double *u_n, double *out);
 
-void euler(double *u, double *u_init, int dim, int numsteps, 
-           double h, double t, derivative_function get_f);
+// Macros for implementation
 
+/** @brief Instantiate rkfixed under suffixed symbols with types and tableau
+ * bound
+ * @details I'll use this in 'rkfixed.cpp' through MAP_TARGETS_TO(). 'name'
+ * is the name of the method, and 'Tab' its tableau type. */
+#define INST_RKFIXED(name, T, Tid, Tab) \
+    void name##Tid(T *u, T *u_init, int dim, int numsteps, T h, T t,      \
+                   void (*get_f)(T, T*, T*))                              \
+    {   rkfixed<Tab, T>(u, u_init, dim, numsteps, h, t, get_f);   }       \
+    int name##_stride##Tid(T *u, T *u_init, int dim, int numsteps, T h,   \
+                           T t, void (*get_f)(T, T*, T*), int stride)     \
+    {   return rkfixed<Tab, T>(u, u_init, dim, numsteps, h, t, get_f,     \
+                               stride);                                   }
+
+// Expose C-extern interfaces of instantiated functions
+// @cond EXPOSE
+
+#ifdef __cplusplus
+extern "C" { // use C linkage. Forbids symbol mangling (and thus overloading)
+#endif
+
+#define EXPOSE_RKFIXED(name, T, Tid) \
+    void name##Tid(T *u, T *u_init, int dim, int numsteps, T h, T t,      \
+                   void (*get_f)(T, T*, T*));                             \
+    int name##_stride##Tid(T *u, T *u_init, int dim, int numsteps, T h,   \
+                           T t, void (*get_f)(T, T*, T*), int stride);
+//  for rkfixed.cpp
+#define EXPOSE_EULER(T, Tid) EXPOSE_RKFIXED(euler, T, Tid)
+MAP_TARGETS_TO(EXPOSE_EULER)
+#define EXPOSE_HEUN(T, Tid) EXPOSE_RKFIXED(heun, T, Tid)
+MAP_TARGETS_TO(EXPOSE_HEUN)
+#define EXPOSE_RK4(T, Tid) EXPOSE_RKFIXED(rk4, T, Tid)
+MAP_TARGETS_TO(EXPOSE_RK4)
+#define EXPOSE_RK38(T, Tid) EXPOSE_RKFIXED(rk38, T, Tid)
+MAP_TARGETS_TO(EXPOSE_RK38)
+
+#ifdef __cplusplus
+} // closing brace for extern "C"
+#endif
+
+// @endcond
 #endif // #include guard
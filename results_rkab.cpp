@@ -1,10 +1,15 @@
 /** @file
- * @brief Implement results_rkab API (ie., provide methods for deletion).
+ * @brief Implement results_rkab API (ie., provide methods for deletion and
+ * statistics), the rkab_context API and the rkab_async API.
  * @details Provides a C interface; see adaptive_step_rk.h for details.
  * @author Jeremiah O'Neil
  * @copyright GNU Public License. */
 #include "rkab.hpp" // templates
+#include "rkab_async.hpp" // background solve templates
 #include "adaptive_step_rk.h" // interface
 
 // Instantiate as defined in adaptive_step_rk.h:
-MAP_TARGETS_TO(INST_DELETE_RESULTS_RKAB) 
+MAP_TARGETS_TO(INST_DELETE_RESULTS_RKAB)
+MAP_TARGETS_TO(INST_RESULTS_RKAB_STATS)
+MAP_TARGETS_TO(INST_RKAB_CONTEXT)
+MAP_TARGETS_TO(INST_RKAB_ASYNC_API)
@@ -4,6 +4,18 @@
  * @author Jeremiah O'Neil
  * @copyright GNU Public License. */
 #include "rkab.hpp" // templates
+#include "rkab_batch.hpp" // batched templates
+#include "rkab_ensemble.hpp" // multithreaded templates
+#include "rkab_observe.hpp" // streaming templates
+#include "rkab_dense.hpp" // dense output templates
+#include "rkab_control.hpp" // step size control templates
+#include "rkab_npy.hpp" // on-disk output templates
+#include "rkab_events.hpp" // event detection templates
+#include "rkab_parareal.hpp" // parallel-in-time templates
+#include "rkab_mixed.hpp" // mixed-precision templates
+#include "rkab_parallel.hpp" // parallel-within-step templates
+#include "rkab_multirate.hpp" // multirate templates
+#include "rkab_async.hpp" // background solve templates
 #include "adaptive_step_rk.h" // interface
 
 /// Runge-Kutta matrix nonzero part, transposed and flattened.
@@ -19,15 +31,47 @@
 #define BB \
     {1/2.L, 1/2.L}
 
+/// Modified Butcher tableau, as a type to bind to rkab() at compile time.
+struct tableau_rk12
+{
+    static constexpr int order = 2, astages = 1, bstages = 2;
+    static constexpr bool fsal = false;
+    static constexpr long double a[] = A, c[] = C, ba[] = BA, bb[] = BB;
+};
+constexpr long double tableau_rk12::a[], tableau_rk12::c[], tableau_rk12::ba[], tableau_rk12::bb[];
+
 /** Instantiate as defined in adaptive_step_rk.h, binding the modified Butcher
  * tableau to an rkab function instance.
  * Should be used through MAP_TARGETS_TO(). */
-#define INST_RK12(T, Tid) \
-    static const T *ba##Tid = (T[])BA, *bb##Tid = (T[])BB, \
-                   *a##Tid = (T[])A, *c##Tid = (T[])C;     \
-    INST_RKAB(12##Tid, T, T, 2, 1, 2,                      \
-              ba##Tid, bb##Tid, a##Tid, c##Tid)            \
-    INST_RKAB(12_arrtol##Tid, T, T *, 2, 1, 2,             \
-              ba##Tid, bb##Tid, a##Tid, c##Tid)
+#define INST_RK12(T, Tid)                                             \
+    INST_RKAB(12##Tid, T, T, tableau_rk12)                            \
+    INST_RKAB(12_arrtol##Tid, T, T *, tableau_rk12)                   \
+    INST_RKAB_OPT(12_opt##Tid, T, tableau_rk12)                       \
+    INST_RKAB_SOLVE(12_solve##Tid, T, T, tableau_rk12)                \
+    INST_RKAB_SOLVE(12_solve_arrtol##Tid, T, T *, tableau_rk12)       \
+    INST_RKAB_BATCH(12_batch##Tid, T, T, tableau_rk12)                \
+    INST_RKAB_BATCH(12_batch_arrtol##Tid, T, T *, tableau_rk12)       \
+    INST_RKAB_ENSEMBLE(12_ensemble##Tid, T, T, tableau_rk12)          \
+    INST_RKAB_ENSEMBLE(12_ensemble_arrtol##Tid, T, T *, tableau_rk12) \
+    INST_RKAB_OBSERVE(12_observe##Tid, T, T, tableau_rk12)            \
+    INST_RKAB_OBSERVE(12_observe_arrtol##Tid, T, T *, tableau_rk12)   \
+    INST_RKAB_NPY(12_npy##Tid, T, T, tableau_rk12)                    \
+    INST_RKAB_NPY(12_npy_arrtol##Tid, T, T *, tableau_rk12)           \
+    INST_RKAB_EVENTS(12_events##Tid, T, T, tableau_rk12)              \
+    INST_RKAB_EVENTS(12_events_arrtol##Tid, T, T *, tableau_rk12)     \
+    INST_RKAB_PARAREAL(12_parareal##Tid, T, T, tableau_rk12)          \
+    INST_RKAB_PARAREAL(12_parareal_arrtol##Tid, T, T *, tableau_rk12) \
+    INST_RKAB_TEVAL(12_teval##Tid, T, T, tableau_rk12)                \
+    INST_RKAB_TEVAL(12_teval_arrtol##Tid, T, T *, tableau_rk12)       \
+    INST_RKAB_PARALLEL(12_parallel##Tid, T, T, tableau_rk12)          \
+    INST_RKAB_PARALLEL(12_parallel_arrtol##Tid, T, T *, tableau_rk12) \
+    INST_RKAB_MULTIRATE(12_multirate##Tid, T, T, tableau_rk12)        \
+    INST_RKAB_MULTIRATE(12_multirate_arrtol##Tid, T, T *, tableau_rk12) \
+    INST_RKAB_ASYNC(12_async##Tid, T, T, tableau_rk12)                \
+    INST_RKAB_ASYNC(12_async_arrtol##Tid, T, T *, tableau_rk12)
 
 MAP_TARGETS_TO(INST_RK12)
+
+// Mixed precision, for the one pair of types
+INST_RKAB_MIXED(12_fd, double, float, double, tableau_rk12)
+INST_RKAB_MIXED(12_arrtol_fd, double, float, double *, tableau_rk12)
@@ -4,6 +4,18 @@
  * @author Jeremiah O'Neil
  * @copyright GNU Public License. */
 #include "rkab.hpp" // templates
+#include "rkab_batch.hpp" // batched templates
+#include "rkab_ensemble.hpp" // multithreaded templates
+#include "rkab_observe.hpp" // streaming templates
+#include "rkab_dense.hpp" // dense output templates
+#include "rkab_control.hpp" // step size control templates
+#include "rkab_npy.hpp" // on-disk output templates
+#include "rkab_events.hpp" // event detection templates
+#include "rkab_parareal.hpp" // parallel-in-time templates
+#include "rkab_mixed.hpp" // mixed-precision templates
+#include "rkab_parallel.hpp" // parallel-within-step templates
+#include "rkab_multirate.hpp" // multirate templates
+#include "rkab_async.hpp" // background solve templates
 #include "adaptive_step_rk.h" // interface
 
 /// Runge-Kutta matrix nonzero part, transposed and flattened.
@@ -21,15 +33,47 @@
 #define BB \
     {7/24.L, 1/4.L, 1/3.L, 1/8.L}
 
+/// Modified Butcher tableau, as a type to bind to rkab() at compile time.
+struct tableau_rk23
+{
+    static constexpr int order = 3, astages = 3, bstages = 4;
+    static constexpr bool fsal = false;
+    static constexpr long double a[] = A, c[] = C, ba[] = BA, bb[] = BB;
+};
+constexpr long double tableau_rk23::a[], tableau_rk23::c[], tableau_rk23::ba[], tableau_rk23::bb[];
+
 /** Instantiate as defined in adaptive_step_rk.h, binding the modified Butcher
  * tableau to an rkab function instance.
  * Should be used through MAP_TARGETS_TO(). */
-#define INST_RK23(T, Tid) \
-    static const T *ba##Tid = (T[])BA, *bb##Tid = (T[])BB, \
-                   *a##Tid = (T[])A, *c##Tid = (T[])C;     \
-    INST_RKAB(23##Tid, T, T, 3, 3, 4,                      \
-              ba##Tid, bb##Tid, a##Tid, c##Tid)            \
-    INST_RKAB(23_arrtol##Tid, T, T *, 3, 3, 4,             \
-              ba##Tid, bb##Tid, a##Tid, c##Tid)
+#define INST_RK23(T, Tid)                                             \
+    INST_RKAB(23##Tid, T, T, tableau_rk23)                            \
+    INST_RKAB(23_arrtol##Tid, T, T *, tableau_rk23)                   \
+    INST_RKAB_OPT(23_opt##Tid, T, tableau_rk23)                       \
+    INST_RKAB_SOLVE(23_solve##Tid, T, T, tableau_rk23)                \
+    INST_RKAB_SOLVE(23_solve_arrtol##Tid, T, T *, tableau_rk23)       \
+    INST_RKAB_BATCH(23_batch##Tid, T, T, tableau_rk23)                \
+    INST_RKAB_BATCH(23_batch_arrtol##Tid, T, T *, tableau_rk23)       \
+    INST_RKAB_ENSEMBLE(23_ensemble##Tid, T, T, tableau_rk23)          \
+    INST_RKAB_ENSEMBLE(23_ensemble_arrtol##Tid, T, T *, tableau_rk23) \
+    INST_RKAB_OBSERVE(23_observe##Tid, T, T, tableau_rk23)            \
+    INST_RKAB_OBSERVE(23_observe_arrtol##Tid, T, T *, tableau_rk23)   \
+    INST_RKAB_NPY(23_npy##Tid, T, T, tableau_rk23)                    \
+    INST_RKAB_NPY(23_npy_arrtol##Tid, T, T *, tableau_rk23)           \
+    INST_RKAB_EVENTS(23_events##Tid, T, T, tableau_rk23)              \
+    INST_RKAB_EVENTS(23_events_arrtol##Tid, T, T *, tableau_rk23)     \
+    INST_RKAB_PARAREAL(23_parareal##Tid, T, T, tableau_rk23)          \
+    INST_RKAB_PARAREAL(23_parareal_arrtol##Tid, T, T *, tableau_rk23) \
+    INST_RKAB_TEVAL(23_teval##Tid, T, T, tableau_rk23)                \
+    INST_RKAB_TEVAL(23_teval_arrtol##Tid, T, T *, tableau_rk23)       \
+    INST_RKAB_PARALLEL(23_parallel##Tid, T, T, tableau_rk23)          \
+    INST_RKAB_PARALLEL(23_parallel_arrtol##Tid, T, T *, tableau_rk23) \
+    INST_RKAB_MULTIRATE(23_multirate##Tid, T, T, tableau_rk23)        \
+    INST_RKAB_MULTIRATE(23_multirate_arrtol##Tid, T, T *, tableau_rk23) \
+    INST_RKAB_ASYNC(23_async##Tid, T, T, tableau_rk23)                \
+    INST_RKAB_ASYNC(23_async_arrtol##Tid, T, T *, tableau_rk23)
 
 MAP_TARGETS_TO(INST_RK23)
+
+// Mixed precision, for the one pair of types
+INST_RKAB_MIXED(23_fd, double, float, double, tableau_rk23)
+INST_RKAB_MIXED(23_arrtol_fd, double, float, double *, tableau_rk23)
@@ -4,6 +4,18 @@
  * @author Jeremiah O'Neil
  * @copyright GNU Public License. */
 #include "rkab.hpp" // templates
+#include "rkab_batch.hpp" // batched templates
+#include "rkab_ensemble.hpp" // multithreaded templates
+#include "rkab_observe.hpp" // streaming templates
+#include "rkab_dense.hpp" // dense output templates
+#include "rkab_control.hpp" // step size control templates
+#include "rkab_npy.hpp" // on-disk output templates
+#include "rkab_events.hpp" // event detection templates
+#include "rkab_parareal.hpp" // parallel-in-time templates
+#include "rkab_mixed.hpp" // mixed-precision templates
+#include "rkab_parallel.hpp" // parallel-within-step templates
+#include "rkab_multirate.hpp" // multirate templates
+#include "rkab_async.hpp" // background solve templates
 #include "adaptive_step_rk.h" // interface
 
 /// Runge-Kutta matrix nonzero part, transposed and flattened.
@@ -23,15 +35,47 @@
 #define BB \
     {16/135.L, 0, 6656/12825.L, 28561/56430.L, -9/50.L, 2/55.L}
 
+/// Modified Butcher tableau, as a type to bind to rkab() at compile time.
+struct tableau_rk45
+{
+    static constexpr int order = 5, astages = 5, bstages = 6;
+    static constexpr bool fsal = false;
+    static constexpr long double a[] = A, c[] = C, ba[] = BA, bb[] = BB;
+};
+constexpr long double tableau_rk45::a[], tableau_rk45::c[], tableau_rk45::ba[], tableau_rk45::bb[];
+
 /** Instantiate as defined in adaptive_step_rk.h, binding the modified Butcher
  * tableau to an rkab function instance.
  * Should be used through MAP_TARGETS_TO(). */
-#define INST_RK45(T, Tid) \
-    static const T *ba##Tid = (T[])BA, *bb##Tid = (T[])BB, \
-                   *a##Tid = (T[])A, *c##Tid = (T[])C;     \
-    INST_RKAB(45##Tid, T, T, 5, 5, 6,                      \
-              ba##Tid, bb##Tid, a##Tid, c##Tid)            \
-    INST_RKAB(45_arrtol##Tid, T, T *, 5, 5, 6,             \
-              ba##Tid, bb##Tid, a##Tid, c##Tid)
+#define INST_RK45(T, Tid)                                             \
+    INST_RKAB(45##Tid, T, T, tableau_rk45)                            \
+    INST_RKAB(45_arrtol##Tid, T, T *, tableau_rk45)                   \
+    INST_RKAB_OPT(45_opt##Tid, T, tableau_rk45)                       \
+    INST_RKAB_SOLVE(45_solve##Tid, T, T, tableau_rk45)                \
+    INST_RKAB_SOLVE(45_solve_arrtol##Tid, T, T *, tableau_rk45)       \
+    INST_RKAB_BATCH(45_batch##Tid, T, T, tableau_rk45)                \
+    INST_RKAB_BATCH(45_batch_arrtol##Tid, T, T *, tableau_rk45)       \
+    INST_RKAB_ENSEMBLE(45_ensemble##Tid, T, T, tableau_rk45)          \
+    INST_RKAB_ENSEMBLE(45_ensemble_arrtol##Tid, T, T *, tableau_rk45) \
+    INST_RKAB_OBSERVE(45_observe##Tid, T, T, tableau_rk45)            \
+    INST_RKAB_OBSERVE(45_observe_arrtol##Tid, T, T *, tableau_rk45)   \
+    INST_RKAB_NPY(45_npy##Tid, T, T, tableau_rk45)                    \
+    INST_RKAB_NPY(45_npy_arrtol##Tid, T, T *, tableau_rk45)           \
+    INST_RKAB_EVENTS(45_events##Tid, T, T, tableau_rk45)              \
+    INST_RKAB_EVENTS(45_events_arrtol##Tid, T, T *, tableau_rk45)     \
+    INST_RKAB_PARAREAL(45_parareal##Tid, T, T, tableau_rk45)          \
+    INST_RKAB_PARAREAL(45_parareal_arrtol##Tid, T, T *, tableau_rk45) \
+    INST_RKAB_TEVAL(45_teval##Tid, T, T, tableau_rk45)                \
+    INST_RKAB_TEVAL(45_teval_arrtol##Tid, T, T *, tableau_rk45)       \
+    INST_RKAB_PARALLEL(45_parallel##Tid, T, T, tableau_rk45)          \
+    INST_RKAB_PARALLEL(45_parallel_arrtol##Tid, T, T *, tableau_rk45) \
+    INST_RKAB_MULTIRATE(45_multirate##Tid, T, T, tableau_rk45)        \
+    INST_RKAB_MULTIRATE(45_multirate_arrtol##Tid, T, T *, tableau_rk45) \
+    INST_RKAB_ASYNC(45_async##Tid, T, T, tableau_rk45)                \
+    INST_RKAB_ASYNC(45_async_arrtol##Tid, T, T *, tableau_rk45)
 
 MAP_TARGETS_TO(INST_RK45)
+
+// Mixed precision, for the one pair of types
+INST_RKAB_MIXED(45_fd, double, float, double, tableau_rk45)
+INST_RKAB_MIXED(45_arrtol_fd, double, float, double *, tableau_rk45)
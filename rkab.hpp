@@ -2,8 +2,10 @@
  * @brief Templates for adaptive step size Runge-Kutta solver.
  * @details Provides a template rkab() for adaptive Runge-Kutta functions of
  * arbitrary Butcher tableau and floating-point compatible data type, which
- * accept tolerance as either a number or an array.
- * Provides templates for the return type of rkab() and its API, and
+ * accept tolerance as either a number or an array. The tableau is a type
+ * parameter, so the stage loop of each method is unrolled at compile time.
+ * Provides templates for the return type of rkab() and its API, for a
+ * context which reuses its memory over many solves (rkab_context), and
  * templates for auxilliary functions used by rkab().
  * @author Jeremiah O'Neil
  * @copyright GNU Public License. */
@@ -18,6 +20,7 @@
 #include <type_traits> // for is_pointer
 #include <vector> // for vectors (dynamic size arrays)
 #include <cmath> // for abs, pow
+#include "rkab_stats.hpp" // for rkab_stats, rkab_probe, ODE_STATS
 using namespace std;
 
 
@@ -36,6 +39,131 @@ struct results_rkab
     T *u;
     /// The number of steps where a failure occured
     int numfailures;
+    /// Pointer to the statistics of the solve, or NULL if the library isn't
+    /// instrumented (see rkab_stats.hpp) or the solver doesn't record them
+    rkab_stats *stats;
+};
+
+/** @brief Structure template describing where rkab_observe() writes output.
+ * @details Rows of output (a parameter and a state) are written to the
+ * buffers 't' and 'u'. Each time the buffers fill, and once at the end, the
+ * rows written since the last call are passed to 'observe', and the buffers
+ * are written again from the start. Without 'observe', the integration stops
+ * once the buffers are full, so they can be preallocated arrays that receive
+ * the whole (decimated) solution in place.
+ * @tparam T Floating-point compatible data type. */
+template<typename T>
+struct rkab_observer
+{
+    /// Write every stride-th accepted step and the last; if not positive,
+    /// write only the last.
+    int stride;
+    /// The number of rows the buffers hold. If the caller's hold none,
+    /// nothing is written, and the integration stops at the first row due.
+    int capacity;
+    /// Buffer of 'capacity' parameters, or NULL to have one allocated.
+    T *t;
+    /// Buffer of 'capacity' states, or NULL to have one allocated.
+    T *u;
+    /// Callback observe(count, *t, *u, data) taking 'count' rows, or NULL.
+    void (*observe)(int count, T *t, T *u, void *data);
+    /// User data passed through to 'observe'.
+    void *data;
+    /// [out] The number of rows written in all.
+    int numrows;
+};
+
+/// Norms of the weighted error for rkab_options::norm
+enum rkab_norm
+{
+    RKAB_NORM_RMS, ///< Root mean square
+    RKAB_NORM_MAX  ///< Maximum
+};
+
+/// Step size controllers for rkab_options::controller
+enum rkab_controller
+{
+    RKAB_CONTROL_I,  ///< Integral (elementary) control
+    RKAB_CONTROL_PI, ///< Proportional-integral control
+    RKAB_CONTROL_PID ///< Proportional-integral-derivative control
+};
+
+/** @brief Structure template of the options of rkab_opt().
+ * @details Component i of the error of a step is weighted by atol_i + rtol_i
+ * * |u_i|, taking the larger |u_i| of either end of the step, so that a
+ * positive absolute tolerance bounds the error of components near zero.
+ * @tparam T Floating-point compatible data type. */
+template<typename T>
+struct rkab_options
+{
+    /// The relative tolerance of every component, unless 'rtols'
+    T rtol;
+    /// The absolute tolerance of every component, unless 'atols'
+    T atol;
+    /// Array of relative tolerances, one per component, or NULL
+    T *rtols;
+    /// Array of absolute tolerances, one per component, or NULL
+    T *atols;
+    /// The norm of the weighted error; see rkab_norm
+    int norm;
+    /// The step size controller; see rkab_controller
+    int controller;
+    /// The magnitude of the first step, or 0 to estimate it
+    T h0;
+};
+
+/** @brief Structure template describing the events to detect and where to
+ * report them.
+ * @details Used by rkab_events_solve() of rkab_events.hpp. Events found are
+ * written to the buffers 't', 'u' and 'which' in order of occurence, up to
+ * 'capacity' of them; 'count' counts all of them.
+ * @tparam T Floating-point compatible data type. */
+template<typename T>
+struct rkab_events
+{
+    /// The number of event functions.
+    int num;
+    /// Callback get_g(t, *u_t, *g) which writes the values of the 'num' event
+    /// functions at system parameter t and state u_t to array g.
+    void (*get_g)(T t, T *u, T *g);
+    /// Per event function: 1 to detect only crossings from negative to
+    /// positive, -1 only from positive to negative, 0 both; or NULL for 0.
+    int *direction;
+    /// Per event function: nonzero to stop the integration at its first
+    /// event; or NULL for none.
+    int *terminal;
+    /// The number of events the buffers hold.
+    int capacity;
+    /// [out] Buffer of 'capacity' parameters at the events.
+    T *t;
+    /// [out] Buffer of 'capacity' states at the events, or NULL.
+    T *u;
+    /// [out] Buffer of 'capacity' indices of the event functions, or NULL.
+    int *which;
+    /// [out] The number of events found.
+    int count;
+};
+
+/** @brief Structure template of the options of rkab_parareal().
+ * @details Used by rkab_parareal() of rkab_parareal.hpp.
+ * @tparam T Floating-point compatible data type. */
+template<typename T>
+struct rkab_parareal_options
+{
+    /// The number of time slices, solved in parallel
+    int numslices;
+    /// The number of fixed steps of the coarse propagator per slice
+    int coarsesteps;
+    /// Stop iterating once no state at a slice boundary changes by more than
+    /// tol * max(|u|, 1) in an iteration
+    T tol;
+    /// The maximum number of iterations, or 0 for numslices (which makes the
+    /// solution that of the sequential method, to round-off)
+    int maxiter;
+    /// The number of threads to use, or 0 for the number of hardware threads
+    int numthreads;
+    /// [out] The number of iterations taken
+    int numiter;
 };
 
 /** @brief Function template for deleting results_rkab instances.
@@ -46,9 +174,52 @@ void delete_results_rkab(results_rkab<T> *results)
 {
     delete [] results->t;
     delete [] results->u;
+    delete results->stats;
     delete results;
 }
 
+/** @brief Function template for deleting arrays of results_rkab instances.
+ * @details Releases each of the results and then the array holding them, as
+ * returned by the solvers that handle many problems at once.
+ * @param results The array of pointers to results.
+ * @param num The number of results in the array. */
+template<typename T>
+void delete_results_rkab_array(results_rkab<T> **results, int num)
+{
+    for (int n = 0; n < num; ++n) {
+        delete_results_rkab<T>(results[n]);
+    }
+    delete [] results;
+}
+
+/** @brief Function template for packaging a solution into a results_rkab.
+ * @details Allocates memory dynamically (persists outside function) for the
+ * results and copies the time and u data from the vectors. I can't return
+ * vectors directly because I want a C-compatible interface.
+ * @param numsteps The number of accepted steps.
+ * @param numfailures The number of steps where a failure occured.
+ * @param tvec The parameter at each accepted step.
+ * @param u The state at each accepted step, concatenated.
+ * @param stats The statistics of the solve to copy, or NULL. */
+template<typename T>
+results_rkab<T> *new_results_rkab(int numsteps, int numfailures,
+                                  const vector<T> &tvec, const vector<T> &u,
+                                  const rkab_stats *stats = 0)
+{
+    T *tarr = new T[tvec.size()]; // time array
+    T *uarr = new T[u.size()]; // u array
+    results_rkab<T> *results = new results_rkab<T> { 
+        numsteps,
+        tarr, // pointer
+        uarr, // pointer
+        numfailures,
+        new_rkab_stats(stats)
+    };
+    copy(tvec.begin(), tvec.end(), tarr);
+    copy(u.begin(), u.end(), uarr);
+    return results;
+}
+
 /** @brief Function template for calculating relative acceptability for scalar
  * tolerance.
  * @details I define acceptability as the minimum over all elements of the
@@ -59,7 +230,7 @@ void delete_results_rkab(results_rkab<T> *results)
  * @param tol The relative tolerance for the local error of the system.
  * @tparam T Floating-point compatible data type. */
 template<typename T>
-T acceptability_rel(int dim, T *ua, T *ub, T tol)
+T acceptability_rel(int dim, const T *ua, const T *ub, T tol)
 {
     T acc = numeric_limits<T>::infinity();
     for (int i = 0; i < dim; ++i) {
@@ -81,7 +252,7 @@ T acceptability_rel(int dim, T *ua, T *ub, T tol)
  * error of the system.
  * @tparam T Floating-point compatible data type. */
 template<typename T>
-T acceptability_rel(int dim, T *ua, T *ub, T *tol)
+T acceptability_rel(int dim, const T *ua, const T *ub, T *tol)
 {
     T acc = numeric_limits<T>::infinity();
     for (int i = 0; i < dim; ++i) {
@@ -89,75 +260,435 @@ T acceptability_rel(int dim, T *ua, T *ub, T *tol)
     }
     return acc;
 }
+
+/// The tolerance of element 'begin' on, for a scalar tolerance: the same.
+template<typename T>
+T rkab_tol_from(T tol, int)
+{
+    return tol;
+}
+
+/// The tolerances of elements 'begin' on, for an array of tolerances.
+template<typename T>
+T *rkab_tol_from(T *tol, int begin)
+{
+    return tol + begin;
+}
+
+/** @brief Class template for the step size control of rkab().
+ * @details Measures the error relative to the high-order state, as
+ * acceptability_rel(), and adapts the step size by the power 1/order of
+ * acceptability, no more than tenfold and no less than half. The first step
+ * is a tenth of the domain, and no more than 0.1. See rkab_integrate_control()
+ * for the interface of step size controls, and rkab_control.hpp for another.
+ * @tparam T Floating-point compatible data type.
+ * @tparam Ttol Tolerance type: should be (scalar) T or (array) T*. */
+template<typename T, typename tolT>
+class rkab_tol_control
+{
+public:
+    rkab_tol_control(tolT tol, int order) :
+        tol(tol), order(order), acc_scale(pow(0.9, order)),
+        max_adapt(10), min_adapt(0.5) {}
+
+    /// The magnitude of the first step.
+    T initial_step(int, T t, T t_end, const T *, T *, T *, T *,
+                   void (*)(T, T*, T*), bool &)
+    {
+        return min(abs(t_end - t)/10, (T)0.1);
+    }
+
+    /// The ratio of tolerance to error of a step; acceptable if > 1.
+    T acceptability(int dim, const T *, T *ua, T *ub)
+    {
+        return scaled(acceptability_rel(dim, ua, ub, tol));
+    }
+
+    /// As acceptability(), over elements [begin, end) only; the least over
+    /// blocks covering a step is its acceptability, exactly.
+    T acceptability_block(int begin, int end, T *ua, T *ub)
+    {
+        return scaled(acceptability_rel(end - begin, ua + begin, ub + begin,
+                                        rkab_tol_from(tol, begin)));
+    }
+
+    /// The acceptability of a step given its acceptability_rel(), for
+    /// solvers which measure that themselves, eg., a lane at a time.
+    T scaled(T acc_rel) const
+    {
+        return acc_scale * acc_rel;
+    }
+
+    /// The factor to adapt the step size by after an accepted step.
+    T accept(T acceptability)
+    { // don't increase by a factor > max_adapt
+        return min(max_adapt, (T)(pow(acceptability, 1.0/order)));
+    }
+
+    /// The factor to adapt the step size by after a rejected step, the first
+    /// of the step or not.
+    T reject(T acceptability, bool first)
+    { // don't decrease by a factor < min_adapt, unless pessimistic
+        return first ? max(min_adapt, (T)(pow(acceptability, 1.0/order)))
+                     : min_adapt;
+    }
+
+private:
+    const tolT tol;
+    const int order;
+    const T acc_scale, max_adapt, min_adapt;
+};
     
-/** @brief Function template for adaptive step size Runge-Kutta methods.
- * @details Solves a given system over parameterized domain to given relative
- * tolerance in local error. Dynamically allocates memory for the solution and
- * returns a pointer to a results_rkab instance containing that solution.
- * @param order,astages,bstages,ba,bb,a,c Modified extended Butcher tableau to
- * on bound on instantiation, defining a particular method. In relation to a
- * standard extended Butcher tableau, 'a' is expected to be transposed and
- * flattened with the  zero half removed and 'ba' and 'c' to have the trailing
- * and leading zeroes respectively removed. 'astages' and 'bstages' are the
- * number of stages of the low- and high-order methods respectively, and
- * 'order' is the order of the high-order method.
+/** @brief Index of an element of the flattened 'a' array of a modified
+ * Butcher tableau.
+ * @details Row k of the transposed matrix holds the weights given to the
+ * derivative of stage k by stages k+1 through bstages-1, so each row is one
+ * element shorter than the last.
+ * @param bstages The number of stages of the high-order method.
+ * @param k The stage whose derivative is weighted (row).
+ * @param j The stage receiving the weight, less one (column). */
+constexpr int tableau_a_index(int bstages, int k, int j)
+{
+    return k * (bstages - 1) - k * (k - 1) / 2 + (j - k);
+}
+
+/** @brief Low-order weight of stage k, or zero past the low-order stages.
+ * @tparam Tab Tableau type; see rkab_integrate(). */
+template<class Tab>
+constexpr long double tableau_ba(int k)
+{
+    return k < Tab::astages ? Tab::ba[k] : 0;
+}
+
+/** @brief Template for summing weighted stage derivatives.
+ * @details Adds w_j * f_j[e] for stages j through k to 's', where w_j is the
+ * weight given by W<Tab>(j), recursing at compile time so that each weight is
+ * a constant and the zero weights are dropped altogether.
+ * @tparam Tab Tableau type; see rkab_integrate().
+ * @tparam T Floating-point compatible data type.
+ * @tparam W Template of a constexpr function giving the weight of stage j.
+ * @tparam j The first stage to sum.
+ * @tparam k The last stage to sum. */
+template<class Tab, typename T, long double (*W)(int), int j, int k,
+         bool done = (j > k)>
+struct rkab_sum
+{
+    static void add(T &s, const T *f, int stride, int e)
+    {
+        if (W(j) != 0) {
+            s += (T)W(j) * f[j * stride + e];
+        }
+        rkab_sum<Tab, T, W, j + 1, k>::add(s, f, stride, e);
+    }
+};
+
+/// @cond IMPL
+template<class Tab, typename T, long double (*W)(int), int j, int k>
+struct rkab_sum<Tab, T, W, j, k, true>
+{
+    static void add(T &, const T *, int, int) {}
+};
+
+/// Weight of the derivative of stage j in the state of stage k+1.
+template<class Tab, int k>
+constexpr long double tableau_a_row(int j)
+{
+    return Tab::a[tableau_a_index(Tab::bstages, j, k)];
+}
+
+/// High-order weight of stage j.
+template<class Tab>
+constexpr long double tableau_bb(int j)
+{
+    return Tab::bb[j];
+}
+/// @endcond
+
+/** @brief Template for the stages of one step of an rkab() method.
+ * @details Stage k+1 is formed in one pass straight from the derivatives of
+ * stages 0 through k, u_k = u_prev + h * sum_j a_(k+1)j f_j, and the last
+ * pass forms the low- and high-order states likewise. Each pass streams
+ * through whole stage arrays, so it vectorizes across the state and needs no
+ * accumulator array. The recursion unrolls the stage loop at compile time, so
+ * the tableau weights are constants and zero weights vanish.
+ * @tparam Tab Tableau type; see rkab_integrate().
+ * @tparam T Floating-point compatible data type.
+ * @tparam k The stage whose derivative has just been evaluated. */
+template<class Tab, typename T, int k = 0,
+         bool last = (k == Tab::bstages - 1)>
+struct rkab_stage
+{
+    static void advance(int dim, T t, T h, T *ua, T *ub, T *u_k,
+                        const T *u_prev, T *f, void (*get_f)(T, T*, T*))
+    {
+        for (int i = 0; i < dim; ++i){
+            T s = 0;
+            rkab_sum<Tab, T, tableau_a_row<Tab, k>, 0, k>::add(s, f, dim, i);
+            u_k[i] = u_prev[i] + h * s;
+        }
+        get_f(t + h * (T)Tab::c[k], u_k, &f[(k + 1) * dim]);
+        rkab_stage<Tab, T, k + 1>::advance(dim, t, h, ua, ub, u_k, u_prev,
+                                           f, get_f);
+    }
+};
+
+/// @cond IMPL
+template<class Tab, typename T, int k>
+struct rkab_stage<Tab, T, k, true>
+{
+    static void advance(int dim, T, T h, T *ua, T *ub, T *,
+                        const T *u_prev, T *f, void (*)(T, T*, T*))
+    { // combine the stages into the low- and high-order states
+        for (int i = 0; i < dim; ++i){
+            T sa = 0, sb = 0;
+            rkab_sum<Tab, T, tableau_ba<Tab>, 0, k>::add(sa, f, dim, i);
+            rkab_sum<Tab, T, tableau_bb<Tab>, 0, k>::add(sb, f, dim, i);
+            ua[i] = u_prev[i] + h * sa;
+            ub[i] = u_prev[i] + h * sb;
+        }
+    }
+};
+/// @endcond
+
+/** @brief Structure template of the stage policy of rkab_integrate_control().
+ * @details Forms the stages of a step with rkab_stage, and makes the other
+ * evaluations of the derivative and copies of whole state arrays of
+ * rkab_integrate_stages(), all on the calling thread. See
+ * rkab_parallel_stages of rkab_parallel.hpp for another.
+ * @tparam Tab Tableau type; see rkab_integrate().
+ * @tparam T Floating-point compatible data type. */
+template<class Tab, typename T>
+struct rkab_stages
+{
+    /// Evaluate the derivative f at (t, u).
+    void derivative(T t, T *u, T *f, void (*get_f)(T, T*, T*))
+    {
+        get_f(t, u, f);
+    }
+
+    /// Form the stages of a step and its low- and high-order states.
+    void advance(int dim, T t, T h, T *ua, T *ub, T *u_k, const T *u_prev,
+                 T *f, void (*get_f)(T, T*, T*))
+    {
+        rkab_stage<Tab, T>::advance(dim, t, h, ua, ub, u_k, u_prev, f,
+                                    get_f);
+    }
+
+    /// Copy the dim elements of 'from' to 'to'.
+    void copy(int dim, const T *from, T *to)
+    {
+        std::copy(from, from + dim, to);
+    }
+};
+
+/** @brief Structure template for the scratch memory of rkab().
+ * @details Holds the temporary state arrays of a solve and the vectors which
+ * collect its trajectory, so that a caller solving many problems in turn
+ * (eg., a worker thread) can reuse them rather than allocate them anew.
+ * @tparam T Floating-point compatible data type. */
+template<typename T>
+struct rkab_workspace
+{
+    int dim; ///< The dimension the arrays are sized for
+    int stages; ///< The number of stages the arrays are sized for
+    T *ua, *ub, *u_k, *u_prev; ///< State arrays of one step
+    T *f; ///< Stage derivatives, stages * dim
+    T *f_next; ///< Derivative at the end of a step, if asked for
+    vector<T> tvec; ///< The parameter at each accepted step
+    vector<T> u; ///< The state at each accepted step, concatenated
+    ODE_STATS(rkab_stats stats;) ///< The statistics of the last solve
+
+    rkab_workspace() :
+        dim(0), stages(0), ua(0), ub(0), u_k(0), u_prev(0), f(0),
+        f_next(0), block(0) {}
+    ~rkab_workspace()
+    {
+        release();
+    }
+
+    /// Ensure the arrays fit a system of dimension dim and 'stages' stages.
+    void reserve(int dim, int stages)
+    {
+        if (dim <= this->dim && stages <= this->stages) {
+            return;
+        }
+        release();
+        this->dim = dim;
+        this->stages = stages;
+        block = new T[(stages + 5) * dim]; // one allocation for all arrays
+        f = block;
+        ua = &block[stages * dim];
+        ub = ua + dim;
+        u_k = ub + dim;
+        u_prev = u_k + dim;
+        f_next = u_prev + dim;
+    }
+
+private:
+    void release()
+    {
+        delete [] block;
+        block = 0;
+        dim = stages = 0;
+    }
+
+    T *block; // the memory of all the arrays
+    // Owns its arrays; not to be copied
+    rkab_workspace(const rkab_workspace &);
+    rkab_workspace &operator=(const rkab_workspace &);
+};
+
+/** @brief Structure template describing an accepted step to the output
+ * policies of rkab_integrate().
+ * @details Carries both ends of the step, so that a policy can interpolate
+ * within it (see hermite_interpolate()). The derivative at the end of the
+ * step is only evaluated if a policy asks for it, and is then reused as the
+ * first stage of the next step.
+ * @tparam T Floating-point compatible data type. */
+template<typename T>
+struct rkab_step
+{
+    T t0; ///< The parameter at the start of the step
+    T t1; ///< The parameter at the end of the step
+    T *u0; ///< The state at the start of the step
+    T *u1; ///< The state at the end of the step
+    T *f0; ///< The derivative at the start of the step
+    const T *f_end; ///< The derivative at the end of the step, if known
+    void (*get_f)(T, T*, T*); ///< The derivative callback
+    T *f_buf; ///< Where to evaluate the derivative at the end
+
+    /// The derivative at the end of the step, evaluated on first request.
+    const T *f1()
+    {
+        if (!f_end) {
+            get_f(t1, u1, f_buf);
+            f_end = f_buf;
+        }
+        return f_end;
+    }
+};
+
+/** @brief Function template for cubic Hermite interpolation within a step.
+ * @details Writes the state at parameter t in [s.t0, s.t1] from the states
+ * and derivatives at both ends of the step. The interpolant is third order,
+ * so its error is of the order of the local error of the low-order methods.
+ * @param dim The dimension of the system.
+ * @param s The step.
+ * @param t The parameter to interpolate at.
+ * @param u [out] The interpolated state. */
+template<typename T>
+void hermite_interpolate(int dim, rkab_step<T> &s, T t, T *u)
+{
+    const T h = s.t1 - s.t0;
+    const T th = (t - s.t0) / h, th2 = th * th, th3 = th2 * th;
+    const T h00 = 2 * th3 - 3 * th2 + 1, h01 = 3 * th2 - 2 * th3;
+    const T h10 = h * (th3 - 2 * th2 + th), h11 = h * (th3 - th2);
+    const T *f1 = s.f1();
+    for (int i = 0; i < dim; ++i) {
+        u[i] = h00 * s.u0[i] + h01 * s.u1[i] + h10 * s.f0[i] + h11 * f1[i];
+    }
+}
+
+/** @brief Output policy of rkab_integrate() which collects the trajectory.
+ * @details Appends every accepted step to the vectors 'tvec' and 'u' of a
+ * workspace (eg., rkab_workspace), from which rkab() packages its results.
+ * @tparam T Floating-point compatible data type. */
+template<typename T>
+struct rkab_trajectory_output
+{
+    int dim; ///< The dimension of the system
+    vector<T> &tvec; ///< The parameter at each accepted step
+    vector<T> &u; ///< The state at each accepted step, concatenated
+
+    template<class Workspace>
+    rkab_trajectory_output(Workspace &ws, int dim) :
+        dim(dim), tvec(ws.tvec), u(ws.u)
+    {
+        tvec.clear();
+        u.clear();
+    }
+
+    /// Record the end of accepted step n.
+    bool step(int, rkab_step<T> &s)
+    {
+        tvec.push_back(s.t1);
+        u.insert(u.end(), s.u1, s.u1 + dim);
+        return true; // never stop early
+    }
+
+    /// Finish with the final state, which step() has already recorded.
+    void finish(int, T, const T *) {}
+};
+
+/** @brief Function template for the integration loop of adaptive step size
+ * Runge-Kutta methods, with a given stage policy and step size control.
+ * @details Solves a given system as rkab_integrate_control() does, but with
+ * the stages of each step, and every other evaluation of the derivative or
+ * copy of a whole state array, made by a stage policy. The policy provides
+ * 'void derivative(t, *u, *f, get_f)', which writes the derivative at (t, u)
+ * to f; 'void advance(dim, t, h, *ua, *ub, *u_k, *u_prev, *f, get_f)', which
+ * forms the stages of a step whose first stage is in f, and writes its low-
+ * and high-order states to ua and ub, as rkab_stage does; and 'void
+ * copy(dim, *from, *to)'. See rkab_stages, and rkab_parallel_stages of
+ * rkab_parallel.hpp.
+ * @param ws The scratch memory to use; see rkab_workspace.
+ * @param stages The stage policy.
  * @param u_init The initial state array of the system.
  * @param dim The dimension of the system.
  * @param maxsteps The maximum number of iterations to run.
- * @param tol The relative tolerance or a pointer to an array of relative
- * tolerances for the local error of the system at each step.
+ * @param ctl The step size control; see rkab_integrate_control().
  * @param t The initial value of the system parameter.
  * @param t_end The target value of the system parameter.
  * @param get_f A callback function get_f(t, *u_t, *f) which writes the
- * derivative of u at system parameter t and state u_t to array f.
+ * derivative of u at system parameter t and state u_t to array f, passed on
+ * to the stage policy, the control and the output policy.
+ * @param out The output policy; see rkab_integrate_control().
+ * @param numfailures [out] The number of steps where a failure occured.
+ * @return The number of accepted steps.
+ * @tparam Tab Tableau type; see rkab_integrate().
  * @tparam T Floating-point compatible data type.
- * @tparam Ttol Tolerance type: should be (scalar) T or (array) T*. */
-template<typename T, typename tolT>
-struct results_rkab<T> *rkab(const int order,
-			     const int astages, const int bstages,
-                             const T *ba, const T *bb, const T *a, const T *c,
-                             T *u_init, int dim, int maxsteps, tolT tol,
-                             T t, T t_end, void (*get_f)(T, T*, T*))
+ * @tparam Stages Stage policy type.
+ * @tparam Control Step size control type.
+ * @tparam Output Output policy type. */
+template<class Tab, typename T, class Stages, class Control, class Output>
+int rkab_integrate_stages(rkab_workspace<T> &ws, Stages &stages, T *u_init,
+                          int dim, int maxsteps, Control &ctl, T t, T t_end,
+                          void (*get_f)(T, T*, T*), Output &out,
+                          int &numfailures)
 {
-    assert(astages < bstages);
-    // Set some resonable acceptance patterns
-    const T acc_scale = pow(0.9, order);
-    const T max_adapt = 10;
-    const T min_adapt = 0.5;
-
-    // Initialize dynamically sized memory for holding results
-    vector<T> tvec;
-    vector<T> u;
-    // Allocate temporary arrays. On heap for safety; don't forget to delete!
-    T *ua = new T[dim];
-    T *ub = new T[dim];
-    T *u_k = new T[dim];
-    T *u_prev = new T[dim]; // for easy re-init on failure
-    T *f = new T[bstages * dim];
-    T *haf = new T[dim * (bstages - 1)];
+    static_assert(Tab::astages <= Tab::bstages,
+                  "the low-order method must not have more stages");
+    const int bstages = Tab::bstages;
+
+    // Temporary arrays
+    ws.reserve(dim, bstages);
+    T *ua = ws.ua;
+    T *ub = ws.ub;
+    T *u_k = ws.u_k;
+    T *u_prev = ws.u_prev;
+    T *f = ws.f;
+    const T *f_last = &f[(bstages - 1) * dim];
 
     // Initialize
-    int numfailures = 0;
+    numfailures = 0;
     int numsteps = 0;
-    copy(u_init, u_init + dim, ua);
-    copy(u_init, u_init + dim, ub);
-    copy(u_init, u_init + dim, u_k);
-    copy(u_init, u_init + dim, u_prev);
-
-    // 'a' is a flattened sparse rep of a triangular matrix; I'll iterate
-    //  through its elements by advancing this pointer.
-    const T *a_k = a;
+    bool stop = false; // set when the output policy calls a halt
+    bool f0_valid = false; // whether f holds stage 1 at (t, u_prev)
+    stages.copy(dim, u_init, u_prev);
+    ODE_STATS(rkab_probe<T> probe(ws.stats, get_f); get_f = probe.get_f();)
 
     // Guess an initial step size
-    T h = min(abs(t_end - t)/10, (T)0.1);
+    T h = ctl.initial_step(dim, t, t_end, u_prev, f, u_k, &f[dim], get_f,
+                           f0_valid);
     // Choose the sign of h according to the direction of propagation
     int t_dir = (t_end >= t) ? 1 : -1;
     h *= t_dir;
 
     // Main loop
-    while (numsteps < maxsteps && t_dir * (t_end - t) > 0)
+    while (!stop && numsteps < maxsteps && t_dir * (t_end - t) > 0)
     {
         bool failures = false;
+        ODE_STATS(long pessimistic = 0;) // rejections since the first
         T hmin = 16 * boost::math::ulp(t);
         // hmin is the minimum meaningful magnitude of h
         if (abs(h) < hmin) { // abs(h) should be >= hmin
@@ -171,92 +702,255 @@ struct results_rkab<T> *rkab(const int order,
         // Loop for advancing one step
         while (true)
         {
-            // Please study these lines carefully. How do they work?    
             // (My tableau has leading zeroes dropped with 'a' transposed)
-            fill(haf, haf + (bstages - 1) * dim, 0); // reset temp 'haf' array
-            a_k = a; // reset to row k = 0
-            get_f(t, u_k, f); // stage 1
-            for (int k = 0; k < bstages - 1; ++k) // stages 2 through last
-            { 
-                for (int i = 0; i < dim; ++i){
-                    T hf_ki = h * f[k * dim + i];
-                    // Update ua[i] and ub[i] now since hf_ki computed
-                    ub[i] += bb[k] * hf_ki;
-                    if (k < astages){ // Likely always true and optimized out
-                        ua[i] += ba[k] * hf_ki;
-                    }
-                    for (int j = k; j < bstages - 1; ++j){
-                        haf[i*(bstages - 1) + j] += hf_ki * a_k[j - k];
-                    } 
-                    u_k[i] = u_prev[i] + haf[i*(bstages - 1) + k];    
-                }
-                get_f(t + h * c[k], u_k, &f[(k + 1) * dim]);            
-                a_k += bstages - 1 - k; // advance to next row
+            if (!f0_valid) { // stage 1, unless known from the last attempt
+                stages.derivative(t, u_prev, f, get_f);
+                f0_valid = true;
             }
-            for (int i = 0; i < dim; ++i){ // finish last stage
-                ub[i] += h * bb[bstages - 1] * f[(bstages - 1) * dim + i]; 
-            } // Note: I asserted astages < bstages, so ua is already complete.
+            // stages 2 through last, unrolled at compile time
+            stages.advance(dim, t, h, ua, ub, u_k, u_prev, f, get_f);
 
             // acceptability = (tolerance) / (relative error)
-            T acceptability = acc_scale * acceptability_rel(dim, ua, ub, tol);
+            T acceptability = ctl.acceptability(dim, u_prev, ua, ub);
             // If the step is acceptable or the step size is minimal
             if (acceptability > 1 || abs(h) <= hmin)
             { // Accept the step
                 ++numsteps;
-                t += h;
-                tvec.push_back(t);
-                copy(ub, ub + dim, ua);
-                copy(ub, ub + dim, u_prev);
-                copy(ub, ub + dim, u_k);
-                u.insert(u.end(), ub, ub + dim);
-                // Adapt step size; don't increase by a factor > max_adapt
-                h *= min(max_adapt, (T)(pow(acceptability, 1.0/order)));
+                ODE_STATS(ws.stats.numhmin += !(acceptability > 1);
+                          rkab_stats_step(ws.stats, h);)
+                // An FSAL tableau's last stage was evaluated at ub exactly
+                rkab_step<T> s = {t, t + h, u_prev, ub, f,
+                                  Tab::fsal ? f_last : 0, get_f, ws.f_next};
+                ODE_STATS(probe.output_begin();)
+                stop = !out.step(numsteps, s);
+                ODE_STATS(probe.output_end();)
+                t = s.t1;
+                // Take stage 1 of the next step if it is already known
+                f0_valid = (s.f_end != 0);
+                if (f0_valid) {
+                    stages.copy(dim, s.f_end, f);
+                }
+                swap(u_prev, ub);
+                h *= ctl.accept(acceptability); // Adapt step size
                 break;
             }
             else
             { // Reject the step
+                ODE_STATS(++ws.stats.numrejections;)
                 if (!failures)
                 {
                     failures = true;
                     ++numfailures;
-                    // Adapt step size; don't decrease by a factor < min_adapt
-                    h *= max(min_adapt, (T)(pow(acceptability, 1.0/order)));
+                    h *= ctl.reject(acceptability, true); // Adapt step size
                 } else { // We underestimated error! Be pessimistic.
-                    h *= min_adapt;
+                    h *= ctl.reject(acceptability, false);
+                    ODE_STATS(++ws.stats.numpessimistic;
+                              ws.stats.maxpessimistic =
+                                  max(ws.stats.maxpessimistic, ++pessimistic);)
                 }
-                copy(u_prev, u_prev + dim, ua);
-                copy(u_prev, u_prev + dim, ub);
-                copy(u_prev, u_prev + dim, u_k);
             }
         }
     }   
-    assert(tvec.size() == (size_t)numsteps);
-    assert(u.size() == (size_t)numsteps * dim); 
+    ODE_STATS(probe.output_begin();)
+    out.finish(numsteps, t, u_prev);
+    ODE_STATS(probe.output_end();)
 
-    // Allocate memory dynamically (persists outside function) for results
-    T *tarr = new T[numsteps]; // time array
-    T *uarr = new T[numsteps * dim]; // u array
-    results_rkab<T> *results = new results_rkab<T> { 
-        numsteps,
-        tarr, // pointer
-        uarr, // pointer
-        numfailures
-    };
-    // Copy time and u data from the vectors.
-    //  Can't return vectors directly because I want a C-compatible interface.
-    copy(tvec.begin(), tvec.end(), tarr);
-    copy(u.begin(), u.end(), uarr);
-    
-    // delete temporary arrays
-    delete [] ua;
-    delete [] ub;
-    delete [] u_k;
-    delete [] u_prev;
-    delete [] f;
-    delete [] haf;
-    // vectors are RAII; they'll be deleted automatically.
+    return numsteps;
+}
 
-    return results;
+/** @brief Function template for the integration loop of adaptive step size
+ * Runge-Kutta methods, with a given step size control.
+ * @details Solves a given system over parameterized domain, handing each
+ * accepted step to an output policy rather than storing it. The policy
+ * provides 'bool step(n, &s)', called with the number and rkab_step of each
+ * accepted step, which returns false to stop the integration there, and 'void
+ * finish(n, t, *u)', called once with the parameter and state of the last
+ * accepted step (n = 0 and the initial state if none).
+ * The control decides which steps are acceptable and how to adapt the step
+ * size. It provides 'T initial_step(dim, t, t_end, *u, *f0, *u_tmp, *f_tmp,
+ * get_f, &f0_valid)', the magnitude of the first step, which may evaluate
+ * the derivative f0 at (t, u) (then setting f0_valid) and use two scratch
+ * arrays; 'T acceptability(dim, *u_prev, *ua, *ub)', the ratio of tolerance
+ * to error of a step, which is acceptable if greater than 1; and 'T
+ * accept(acceptability)' and 'T reject(acceptability, first)', the factors to
+ * adapt the step size by after an accepted step and after a rejected one
+ * (the first of its step or not). See rkab_tol_control.
+ * The stages are formed by rkab_stages; see rkab_integrate_stages() for
+ * other stage policies.
+ * @param ws The scratch memory to use; see rkab_workspace.
+ * @param u_init The initial state array of the system.
+ * @param dim The dimension of the system.
+ * @param maxsteps The maximum number of iterations to run.
+ * @param ctl The step size control.
+ * @param t The initial value of the system parameter.
+ * @param t_end The target value of the system parameter.
+ * @param get_f A callback function get_f(t, *u_t, *f) which writes the
+ * derivative of u at system parameter t and state u_t to array f.
+ * @param out The output policy.
+ * @param numfailures [out] The number of steps where a failure occured.
+ * @return The number of accepted steps.
+ * @tparam Tab Tableau type; see rkab_integrate().
+ * @tparam T Floating-point compatible data type.
+ * @tparam Control Step size control type.
+ * @tparam Output Output policy type. */
+template<class Tab, typename T, class Control, class Output>
+int rkab_integrate_control(rkab_workspace<T> &ws, T *u_init, int dim,
+                           int maxsteps, Control &ctl, T t, T t_end,
+                           void (*get_f)(T, T*, T*), Output &out,
+                           int &numfailures)
+{
+    rkab_stages<Tab, T> stages;
+    return rkab_integrate_stages<Tab, T>(ws, stages, u_init, dim, maxsteps,
+                                         ctl, t, t_end, get_f, out,
+                                         numfailures);
+}
+
+/** @brief Function template for the integration loop of adaptive step size
+ * Runge-Kutta methods.
+ * @details Solves a given system over parameterized domain to given relative
+ * tolerance in local error with rkab_integrate_control(), handing each
+ * accepted step to an output policy, with the step size control of
+ * rkab_tol_control.
+ * @param ws The scratch memory to use; see rkab_workspace.
+ * @param u_init The initial state array of the system.
+ * @param dim The dimension of the system.
+ * @param maxsteps The maximum number of iterations to run.
+ * @param tol The relative tolerance or a pointer to an array of relative
+ * tolerances for the local error of the system at each step.
+ * @param t The initial value of the system parameter.
+ * @param t_end The target value of the system parameter.
+ * @param get_f A callback function get_f(t, *u_t, *f) which writes the
+ * derivative of u at system parameter t and state u_t to array f.
+ * @param out The output policy; see rkab_integrate_control().
+ * @param numfailures [out] The number of steps where a failure occured.
+ * @return The number of accepted steps.
+ * @tparam Tab Modified extended Butcher tableau, bound on instantiation,
+ * defining a particular method. It provides constexpr members 'order',
+ * 'astages', 'bstages', 'fsal', 'ba', 'bb', 'a' and 'c'. In relation to a standard
+ * extended Butcher tableau, 'a' is expected to be transposed and flattened
+ * with the zero half removed and 'ba' and 'c' to have the trailing and
+ * leading zeroes respectively removed. 'astages' and 'bstages' are the number
+ * of stages of the low- and high-order methods respectively, and 'order' is
+ * the order of the high-order method. 'fsal' is set if the last stage is
+ * evaluated at the high-order state (first same as last), so that its
+ * derivative serves as the first stage of the next step. See rk45.cpp and
+ * rkdp54.cpp for examples.
+ * @tparam T Floating-point compatible data type.
+ * @tparam Ttol Tolerance type: should be (scalar) T or (array) T*.
+ * @tparam Output Output policy type. */
+template<class Tab, typename T, typename tolT, class Output>
+int rkab_integrate(rkab_workspace<T> &ws, T *u_init, int dim, int maxsteps,
+                   tolT tol, T t, T t_end, void (*get_f)(T, T*, T*),
+                   Output &out, int &numfailures)
+{
+    rkab_tol_control<T, tolT> ctl(tol, Tab::order);
+    return rkab_integrate_control<Tab, T>(ws, u_init, dim, maxsteps, ctl,
+                                          t, t_end, get_f, out, numfailures);
+}
+
+/** @brief Function template for adaptive step size Runge-Kutta methods.
+ * @details Solves a given system over parameterized domain to given relative
+ * tolerance in local error with rkab_integrate(). Dynamically allocates memory
+ * for the solution and returns a pointer to a results_rkab instance
+ * containing that solution.
+ * @param ws The scratch memory to use; see rkab_workspace.
+ * @param u_init The initial state array of the system.
+ * @param dim The dimension of the system.
+ * @param maxsteps The maximum number of iterations to run.
+ * @param tol The relative tolerance or a pointer to an array of relative
+ * tolerances for the local error of the system at each step.
+ * @param t The initial value of the system parameter.
+ * @param t_end The target value of the system parameter.
+ * @param get_f A callback function get_f(t, *u_t, *f) which writes the
+ * derivative of u at system parameter t and state u_t to array f.
+ * @tparam Tab Tableau type; see rkab_integrate().
+ * @tparam T Floating-point compatible data type.
+ * @tparam Ttol Tolerance type: should be (scalar) T or (array) T*. */
+template<class Tab, typename T, typename tolT>
+struct results_rkab<T> *rkab(rkab_workspace<T> &ws, T *u_init, int dim,
+                             int maxsteps, tolT tol, T t, T t_end,
+                             void (*get_f)(T, T*, T*))
+{
+    rkab_trajectory_output<T> out(ws, dim);
+    int numfailures;
+    int numsteps = rkab_integrate<Tab, T, tolT>(ws, u_init, dim, maxsteps,
+                                                tol, t, t_end, get_f,
+                                                out, numfailures);
+    assert(out.tvec.size() == (size_t)numsteps);
+    assert(out.u.size() == (size_t)numsteps * dim); 
+
+    return new_results_rkab(numsteps, numfailures, out.tvec, out.u,
+                            ODE_STATS_OF(ws));
+}
+
+/** @brief Structure template for a reusable solver context.
+ * @details Holds an rkab_workspace, whose vectors serve as the output arena,
+ * and the results_rkab describing the last solution. The stage arrays are
+ * allocated by the first solve of a method with more stages than any before.
+ * @tparam T Floating-point compatible data type. */
+template<typename T>
+struct rkab_context
+{
+    int dim; ///< The dimension of the system
+    rkab_workspace<T> ws; ///< Scratch memory and output arena
+    results_rkab<T> results; ///< The last solution, a view of the arena
+
+    /** @param dim The dimension of the system.
+     * @param capacity The number of steps to reserve room for in the arena
+     * (a hint; the arena grows as needed). */
+    rkab_context(int dim, int capacity) :
+        dim(dim), results()
+    {
+        ws.tvec.reserve(max(capacity, 0));
+        ws.u.reserve((size_t)max(capacity, 0) * dim);
+    }
+
+    /** @brief Solve a given system with the method of tableau Tab.
+     * @details As rkab(), but the returned solution lives in the context
+     * until the next solve, reset or destruction, and must not be deleted.
+     * @tparam Tab Tableau type; see rkab_integrate().
+     * @tparam Ttol Tolerance type: should be (scalar) T or (array) T*. */
+    template<class Tab, typename tolT>
+    const results_rkab<T> *solve(T *u_init, int maxsteps, tolT tol, T t,
+                                 T t_end, void (*get_f)(T, T*, T*))
+    {
+        rkab_trajectory_output<T> out(ws, dim);
+        results.numsteps = rkab_integrate<Tab, T, tolT>(ws, u_init, dim,
+                                                        maxsteps, tol, t,
+                                                        t_end, get_f, out,
+                                                        results.numfailures);
+        results.t = ws.tvec.data();
+        results.u = ws.u.data();
+        results.stats = ODE_STATS_OF(ws);
+        return &results;
+    }
+
+    /// Forget the last solution, keeping the memory for the next.
+    void reset()
+    {
+        ws.tvec.clear();
+        ws.u.clear();
+        results = results_rkab<T>();
+    }
+};
+
+/// Handle to a solve running in the background; see rkab_async.hpp.
+template<typename T>
+class rkab_async;
+
+/** @brief Function template for adaptive step size Runge-Kutta methods.
+ * @details As above, with an rkab_context of its own, out of which the
+ * solution is copied.
+ * @tparam Tab Tableau type; see rkab_integrate(). */
+template<class Tab, typename T, typename tolT>
+struct results_rkab<T> *rkab(T *u_init, int dim, int maxsteps, tolT tol,
+                             T t, T t_end, void (*get_f)(T, T*, T*))
+{
+    rkab_context<T> ctx(dim, 0); // RAII; deleted automatically.
+    const results_rkab<T> *r = ctx.template solve<Tab>(u_init, maxsteps, tol,
+                                                       t, t_end, get_f);
+    return new_results_rkab(r->numsteps, r->numfailures, ctx.ws.tvec,
+                            ctx.ws.u, r->stats);
 }
 
 #endif // #include guard
@@ -0,0 +1,207 @@
+/** @file
+ * @brief Templates for adaptive step size Runge-Kutta solves run in the
+ * background.
+ * @details Provides a class template rkab_async, a handle to a solve by
+ * rkab_integrate_control() on a thread of its own, through which the thread
+ * that started it can poll its progress, cancel it, and wait for its results
+ * or take a copy of them so far. Cancellation is a lock-free flag, which the
+ * solver checks at every accepted step; a cancelled solve stops there, with
+ * its results up to that step. The progress and the trajectory are
+ * published under a lock taken by the solver once per accepted step, so
+ * that they always agree with one another.
+ * @author Jeremiah O'Neil
+ * @copyright GNU Public License. */
+#ifndef INC_RKAB_ASYNC_hpp // #include guard
+#define INC_RKAB_ASYNC_hpp // ensure this file is included at most once per unit
+
+#include <atomic> // for atomic
+#include <mutex> // for mutex, lock_guard
+#include <thread> // for thread
+#include "rkab.hpp" // rkab_integrate_control, rkab_workspace, rkab_tol_control
+
+/** @brief Class template for the step size control of rkab_async: that of
+ * rkab_tol_control, counting the steps where a failure occured as it goes.
+ * @tparam T Floating-point compatible data type.
+ * @tparam Ttol Tolerance type: should be (scalar) T or (array) T*. */
+template<typename T, typename tolT>
+class rkab_async_control : public rkab_tol_control<T, tolT>
+{
+public:
+    rkab_async_control(tolT tol, int order) :
+        rkab_tol_control<T, tolT>(tol, order), numfailures(0) {}
+
+    /// As rkab_tol_control::reject(), counting the first of each step.
+    T reject(T acceptability, bool first)
+    {
+        numfailures += first;
+        return rkab_tol_control<T, tolT>::reject(acceptability, first);
+    }
+
+    int numfailures; ///< The number of steps where a failure occured
+};
+
+/** @brief Class template of a solve running in the background.
+ * @details Created by start(), which returns at once. The derivative
+ * callback is called on the solve's own thread. The methods may be called
+ * from any one thread at a time, but poll() and cancel() from any number.
+ * @tparam T Floating-point compatible data type. */
+template<typename T>
+class rkab_async
+{
+public:
+    /** @brief Start solving a given system with the method of tableau Tab.
+     * @details The arguments are those of rkab(); the initial state and any
+     * array of tolerances are copied, so they needn't outlive the call.
+     * @return A handle to the solve, to be destroyed with delete (which
+     * cancels the solve and waits for it).
+     * @tparam Tab Tableau type; see rkab_integrate().
+     * @tparam Ttol Tolerance type: should be (scalar) T or (array) T*. */
+    template<class Tab, typename tolT>
+    static rkab_async *start(T *u_init, int dim, int maxsteps, tolT tol, T t,
+                             T t_end, void (*get_f)(T, T*, T*))
+    {
+        rkab_async *a = new rkab_async(u_init, dim, t);
+        a->worker = thread(&rkab_async::template solve<Tab, tolT>, a,
+                           maxsteps, a->keep(tol), t, t_end, get_f);
+        return a;
+    }
+
+    ~rkab_async()
+    {
+        cancel();
+        wait();
+    }
+
+    /** @brief Read the progress of the solve: the parameter, the number of
+     * accepted steps and the number of steps where a failure occured, as of
+     * the last accepted step. Any of the pointers may be NULL.
+     * @return Whether the solve has finished. */
+    bool poll(T *t, int *numsteps, int *numfailures) const
+    {
+        bool done = finished.load(memory_order_acquire);
+        lock_guard<mutex> guard(lock);
+        if (t) {
+            *t = t_now;
+        }
+        if (numsteps) {
+            *numsteps = steps_now;
+        }
+        if (numfailures) {
+            *numfailures = failures_now;
+        }
+        return done;
+    }
+
+    /// Ask the solve to stop at its next accepted step; doesn't wait.
+    void cancel()
+    {
+        cancelled.store(true, memory_order_relaxed);
+    }
+
+    /** @brief Wait for the solve to finish, by reaching its end, maxsteps or
+     * a cancellation.
+     * @return Its results, which live in the handle until it is destroyed,
+     * and must not be deleted. */
+    const results_rkab<T> *wait()
+    {
+        if (worker.joinable()) {
+            worker.join();
+            results.numsteps = steps_now;
+            results.t = ws.tvec.data();
+            results.u = ws.u.data();
+            results.numfailures = failures_now;
+            results.stats = ODE_STATS_OF(ws);
+        }
+        return &results;
+    }
+
+    /** @brief Copy the results so far, up to the last accepted step, without
+     * waiting.
+     * @return A new results_rkab; see delete_results_rkab(). The statistics
+     * are only copied once the solve has finished. */
+    results_rkab<T> *snapshot() const
+    {
+        bool done = finished.load(memory_order_acquire);
+        lock_guard<mutex> guard(lock);
+        return new_results_rkab(steps_now, failures_now, ws.tvec, ws.u,
+                                done ? ODE_STATS_OF(ws) : 0);
+    }
+
+private:
+    rkab_async(T *u_init, int dim, T t) :
+        dim(dim), u_init(u_init, u_init + dim), t_now(t), steps_now(0),
+        failures_now(0), cancelled(false), finished(false), results() {}
+
+    /// Output policy publishing each accepted step, and checking for a
+    /// cancellation.
+    template<typename tolT>
+    struct output
+    {
+        rkab_async &a;
+        const rkab_async_control<T, tolT> &ctl;
+
+        bool step(int n, rkab_step<T> &s)
+        {
+            {
+                lock_guard<mutex> guard(a.lock);
+                a.ws.tvec.push_back(s.t1);
+                a.ws.u.insert(a.ws.u.end(), s.u1, s.u1 + a.dim);
+                a.t_now = s.t1;
+                a.steps_now = n;
+                a.failures_now = ctl.numfailures;
+            }
+            return !a.cancelled.load(memory_order_relaxed);
+        }
+
+        void finish(int, T, const T *) {}
+    };
+
+    /// Body of the solve's thread.
+    template<class Tab, typename tolT>
+    void solve(int maxsteps, tolT tol, T t, T t_end,
+               void (*get_f)(T, T*, T*))
+    {
+        rkab_async_control<T, tolT> ctl(tol, Tab::order);
+        output<tolT> out = {*this, ctl};
+        int numfailures;
+        rkab_integrate_control<Tab, T>(ws, u_init.data(), dim, maxsteps, ctl,
+                                       t, t_end, get_f, out, numfailures);
+        {
+            lock_guard<mutex> guard(lock);
+            failures_now = numfailures; // counting any after the last step
+        }
+        finished.store(true, memory_order_release);
+    }
+
+    /// The tolerance to solve with, for a scalar tolerance: the same.
+    T keep(T tol)
+    {
+        return tol;
+    }
+
+    /// The tolerances to solve with, for an array of tolerances: a copy.
+    T *keep(T *tol)
+    {
+        tols.assign(tol, tol + dim);
+        return tols.data();
+    }
+
+    const int dim; // the dimension of the system
+    vector<T> u_init; // a copy of the initial state
+    vector<T> tols; // a copy of the tolerances, if an array
+    rkab_workspace<T> ws; // scratch memory; its trajectory is under the lock
+    mutable mutex lock; // guards the trajectory and the progress
+    T t_now; // the parameter at the last accepted step
+    int steps_now; // the number of accepted steps
+    int failures_now; // the number of steps where a failure occured
+    atomic<bool> cancelled; // set to ask the solve to stop
+    atomic<bool> finished; // set once the solve has stopped
+    results_rkab<T> results; // the results, a view of ws, once waited for
+    thread worker; // the solve's thread, until waited for
+
+    // Owns its thread; not to be copied
+    rkab_async(const rkab_async &);
+    rkab_async &operator=(const rkab_async &);
+};
+
+#endif // #include guard
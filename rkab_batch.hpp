@@ -0,0 +1,375 @@
+/** @file
+ * @brief Templates for batched adaptive step size Runge-Kutta solvers.
+ * @details Provides a template rkab_batch() which solves many independent
+ * initial value problems of one system at once, for any tableau accepted by
+ * rkab(). The states are held in structure-of-arrays layout (component-major,
+ * trajectory-minor), so the stage arithmetic runs across trajectories in SIMD
+ * lanes and the derivative callback is called once per stage for the whole
+ * batch. Every trajectory keeps its own step size and failure count, exactly
+ * as if it had been solved by rkab() alone.
+ * @author Jeremiah O'Neil
+ * @copyright GNU Public License. */
+#ifndef INC_RKAB_BATCH_hpp // #include guard
+#define INC_RKAB_BATCH_hpp // ensure this file is included at most once per unit
+
+#include "rkab.hpp" // tableau helpers, results_rkab, rkab_tol_control
+
+/// Width in bytes of the vector registers the lanes are padded to fill.
+#ifndef RKAB_SIMD_BYTES
+    #if defined(__AVX512F__)
+        #define RKAB_SIMD_BYTES 64
+    #elif defined(__AVX__)
+        #define RKAB_SIMD_BYTES 32
+    #else
+        #define RKAB_SIMD_BYTES 16
+    #endif
+#endif
+
+/// Target size in bytes of the working set of a block of trajectories.
+#ifndef RKAB_BATCH_BYTES
+    #define RKAB_BATCH_BYTES (128 * 1024)
+#endif
+
+/** @brief Number of trajectories of type T which fit in a vector register.
+ * @details The batch is padded to a multiple of this, so the lane loops run
+ * without a scalar remainder.
+ * @tparam T Floating-point compatible data type. */
+template<typename T>
+struct simd_lanes
+{
+    static const int value = RKAB_SIMD_BYTES / sizeof(T) > 1
+                           ? RKAB_SIMD_BYTES / sizeof(T) : 1;
+};
+
+/// @cond IMPL
+template<>
+struct simd_lanes<long double> // x87 arithmetic has no vector registers
+{
+    static const int value = 1;
+};
+/// @endcond
+
+/** @brief Function template for calculating relative acceptability of each
+ * trajectory of a batch.
+ * @details As acceptability_rel(), reduced over the components of each lane
+ * rather than over the whole array.
+ * @param dim The dimension of the system.
+ * @param n The number of lanes (stride of the component arrays).
+ * @param ua Proposed states of the batch.
+ * @param ub Proposed states of the batch computed to a higher order.
+ * @param tol The relative tolerance or a pointer to an array of relative
+ * tolerances for the local error of the system.
+ * @param acc [out] The acceptability of each lane.
+ * @tparam T Floating-point compatible data type.
+ * @tparam Ttol Tolerance type: should be (scalar) T or (array) T*. */
+template<typename T, typename tolT>
+void acceptability_rel_lanes(int dim, int n, const T *ua, const T *ub,
+                             tolT tol, T *acc)
+{
+    fill(acc, acc + n, numeric_limits<T>::infinity());
+    for (int i = 0; i < dim; ++i) {
+        const tolT tol_i = rkab_tol_from(tol, i);
+        const T *ua_i = &ua[i * n], *ub_i = &ub[i * n];
+        for (int l = 0; l < n; ++l) {
+            acc[l] = min(acc[l], acceptability_rel(1, &ua_i[l], &ub_i[l],
+                                                   tol_i));
+        }
+    }
+}
+
+/** @brief Template for the stages of one step of a batch.
+ * @details As rkab_stage, with the passes running across lanes. 't_k' is a
+ * scratch lane array.
+ * @tparam Tab Tableau type; see rkab_integrate().
+ * @tparam T Floating-point compatible data type.
+ * @tparam k The stage whose derivative has just been evaluated. */
+template<class Tab, typename T, int k = 0,
+         bool last = (k == Tab::bstages - 1)>
+struct rkab_batch_stage
+{
+    static void advance(int dim, int n, const T *t, const T *h,
+                        T *ua, T *ub, T *u_k, const T *u_prev, T *f,
+                        T *t_k, void (*get_f)(T*, T*, T*, int))
+    {
+        const int stride = dim * n; // between stages of 'f'
+        for (int i = 0; i < dim; ++i){
+            const int o = i * n;
+            for (int l = 0; l < n; ++l) {
+                T s = 0;
+                rkab_sum<Tab, T, tableau_a_row<Tab, k>, 0, k>::add(
+                    s, f, stride, o + l);
+                u_k[o + l] = u_prev[o + l] + h[l] * s;
+            }
+        }
+        for (int l = 0; l < n; ++l) {
+            t_k[l] = t[l] + h[l] * (T)Tab::c[k];
+        }
+        get_f(t_k, u_k, &f[(k + 1) * stride], n);
+        rkab_batch_stage<Tab, T, k + 1>::advance(dim, n, t, h, ua, ub, u_k,
+                                                 u_prev, f, t_k, get_f);
+    }
+};
+
+/// @cond IMPL
+template<class Tab, typename T, int k>
+struct rkab_batch_stage<Tab, T, k, true>
+{
+    static void advance(int dim, int n, const T *, const T *h,
+                        T *ua, T *ub, T *, const T *u_prev, T *f,
+                        T *, void (*)(T*, T*, T*, int))
+    { // combine the stages into the low- and high-order states
+        const int stride = dim * n;
+        for (int i = 0; i < dim; ++i){
+            const int o = i * n;
+            for (int l = 0; l < n; ++l) {
+                T sa = 0, sb = 0;
+                rkab_sum<Tab, T, tableau_ba<Tab>, 0, k>::add(
+                    sa, f, stride, o + l);
+                rkab_sum<Tab, T, tableau_bb<Tab>, 0, k>::add(
+                    sb, f, stride, o + l);
+                ua[o + l] = u_prev[o + l] + h[l] * sa;
+                ub[o + l] = u_prev[o + l] + h[l] * sb;
+            }
+        }
+    }
+};
+/// @endcond
+
+/** @brief Function template for batched adaptive step size Runge-Kutta
+ * methods.
+ * @details Solves 'num' initial value problems of a given system over a
+ * common parameterized domain, each to given relative tolerance in local
+ * error, with the step size control of rkab(). The trajectories are advanced
+ * together in lanes padded to a multiple of simd_lanes<T>; each lane accepts
+ * or rejects its own step, and finished trajectories are masked out of the
+ * arithmetic and compacted out of the batch as their number falls. Returns an
+ * array of pointers to results_rkab instances, one per trajectory.
+ * @param u_init The initial states in structure-of-arrays layout: component
+ * i of trajectory l is u_init[i * num + l].
+ * @param dim The dimension of the system.
+ * @param num The number of trajectories.
+ * @param maxsteps The maximum number of iterations to run per trajectory.
+ * @param tol The relative tolerance or a pointer to an array of relative
+ * tolerances for the local error of the system at each step.
+ * @param t_init The initial value of the system parameter.
+ * @param t_end The target value of the system parameter.
+ * @param get_f A callback function get_f(*t, *u, *f, n) which writes the
+ * derivatives of n trajectories at system parameters t[l] and states u to
+ * array f, where u and f are in structure-of-arrays layout with stride n.
+ * @tparam Tab Tableau type; see rkab_integrate().
+ * @tparam T Floating-point compatible data type.
+ * @tparam Ttol Tolerance type: should be (scalar) T or (array) T*. */
+template<class Tab, typename T, typename tolT>
+results_rkab<T> **rkab_batch(T *u_init, int dim, int num, int maxsteps,
+                             tolT tol, T t_init, T t_end,
+                             void (*get_f)(T*, T*, T*, int))
+{
+    static_assert(Tab::astages <= Tab::bstages,
+                  "the low-order method must not have more stages");
+    const int bstages = Tab::bstages;
+    const int width = simd_lanes<T>::value;
+    // One controller serves every lane; it keeps no state between steps
+    rkab_tol_control<T, tolT> ctl(tol, Tab::order);
+
+    // Initialize dynamically sized memory for holding results
+    vector<vector<T> > tvec(num);
+    vector<vector<T> > u(num);
+    vector<int> numsteps(num, 0);
+    vector<int> numfailures(num, 0);
+
+    // Trajectories are solved a block at a time, so a block's stages stay
+    //  in cache. Lane l of a block holds trajectory lane[l], or -1 for
+    //  padding and finished trajectories. Blocks are padded to the SIMD width.
+    const size_t lane_bytes = (bstages + 4) * dim * sizeof(T);
+    int block = max((size_t)1, RKAB_BATCH_BYTES / lane_bytes);
+    block = min(block, (num + width - 1) / width * width);
+    block = max(width, block / width * width);
+    vector<int> lane(block);
+    vector<char> failures(block);
+    vector<char> fresh(block); // lane is starting a new step
+    vector<int> src(block); // for compacting lanes
+    // Allocate temporary arrays. On heap for safety; don't forget to delete!
+    T *t = new T[block];
+    T *h = new T[block];
+    T *hmin = new T[block]; // the minimum meaningful magnitude of h
+    T *acc = new T[block];
+    T *t_k = new T[block];
+    T *ua = new T[dim * block];
+    T *ub = new T[dim * block];
+    T *u_k = new T[dim * block];
+    T *u_prev = new T[dim * block]; // for easy re-init on failure
+    T *f = new T[bstages * dim * block];
+
+    // Guess an initial step size; it evaluates no derivative
+    bool f0_valid = false;
+    T h_init = ctl.initial_step(dim, t_init, t_end, 0, 0, 0, 0, 0, f0_valid);
+    // Choose the sign of h according to the direction of propagation
+    int t_dir = (t_end >= t_init) ? 1 : -1;
+    h_init *= t_dir;
+
+    for (int p0 = 0; p0 < num; p0 += block)
+    {
+        // Initialize; padding lanes copy the first trajectory with a null step
+        const int nb = min(block, num - p0);
+        int n = (nb + width - 1) / width * width;
+        int active = (maxsteps > 0 && t_dir * (t_end - t_init) > 0) ? nb : 0;
+        bool need_f0 = true; // whether stage 1 must be evaluated
+        for (int l = 0; l < n; ++l) {
+            const int p = p0 + ((l < nb) ? l : 0);
+            lane[l] = (l < active) ? p : -1;
+            failures[l] = false;
+            fresh[l] = true;
+            t[l] = t_init;
+            h[l] = (l < active) ? h_init : 0;
+            for (int i = 0; i < dim; ++i) {
+                u_prev[i * n + l] = u_init[i * num + p];
+            }
+        }
+
+        // Main loop: every active lane attempts one step per iteration
+        while (active > 0)
+        {
+            for (int l = 0; l < n; ++l) {
+                if (lane[l] < 0 || !fresh[l]) {
+                    continue;
+                }
+                fresh[l] = false;
+                failures[l] = false;
+                hmin[l] = 16 * boost::math::ulp(t[l]);
+                // hmin is the minimum meaningful magnitude of h
+                if (abs(h[l]) < hmin[l]) { // abs(h) should be >= hmin
+                    h[l] = t_dir * hmin[l];
+                }
+                // But make sure to hit the last step exactly
+                if (t_dir * (t_end - t[l] - h[l]) < 0){
+                    h[l] = t_end - t[l];
+                }
+            }
+
+            if (need_f0) { // stage 1, unless every lane already has it
+                get_f(t, u_prev, f, n);
+                need_f0 = false;
+            }
+            // stages 2 through last, unrolled at compile time
+            rkab_batch_stage<Tab, T>::advance(dim, n, t, h, ua, ub, u_k,
+                                              u_prev, f, t_k, get_f);
+            acceptability_rel_lanes(dim, n, ua, ub, tol, acc);
+
+            bool finished = false;
+            for (int l = 0; l < n; ++l) {
+                const int p = lane[l];
+                if (p < 0) {
+                    continue;
+                }
+                // acceptability = (tolerance) / (relative error)
+                T acceptability = ctl.scaled(acc[l]);
+                // If the step is acceptable or the step size is minimal
+                if (acceptability > 1 || abs(h[l]) <= hmin[l])
+                { // Accept the step
+                    ++numsteps[p];
+                    t[l] += h[l];
+                    tvec[p].push_back(t[l]);
+                    for (int i = 0; i < dim; ++i) {
+                        u_prev[i * n + l] = ub[i * n + l];
+                        u[p].push_back(ub[i * n + l]);
+                    }
+                    if (Tab::fsal) { // the last stage is the next's first
+                        const T *f_last = &f[(bstages - 1) * dim * n];
+                        for (int i = 0; i < dim; ++i) {
+                            f[i * n + l] = f_last[i * n + l];
+                        }
+                    } else {
+                        need_f0 = true;
+                    }
+                    h[l] *= ctl.accept(acceptability); // adapt step size
+                    fresh[l] = true;
+                    if (numsteps[p] >= maxsteps || t_dir * (t_end - t[l]) <= 0) {
+                        // Trajectory done; mask it out with a null step
+                        lane[l] = -1;
+                        h[l] = 0;
+                        --active;
+                        finished = true;
+                    }
+                }
+                else
+                { // Reject the step
+                    // Adapt step size, pessimistically if we underestimated
+                    //  the error of a step already rejected
+                    h[l] *= ctl.reject(acceptability, !failures[l]);
+                    if (!failures[l])
+                    {
+                        failures[l] = true;
+                        ++numfailures[p];
+                    }
+                }
+            }
+
+            // Compact the active lanes to the front once a vector's worth of
+            //  lanes has finished, so the callback and arithmetic skip them.
+            const int n_new = (active + width - 1) / width * width;
+            if (finished && active > 0 && n_new < n) {
+                int m = 0;
+                for (int l = 0; l < n; ++l) {
+                    if (lane[l] < 0) {
+                        continue;
+                    }
+                    lane[m] = lane[l];
+                    t[m] = t[l];
+                    h[m] = h[l];
+                    hmin[m] = hmin[l];
+                    failures[m] = failures[l];
+                    fresh[m] = fresh[l];
+                    src[m] = l; // remember where the lane came from
+                    ++m;
+                }
+                // Moving lane src[m] to lane m <= src[m] with stride n_new <= n in
+                //  this order never overwrites an element yet to be moved.
+                for (int i = 0; i < dim; ++i) {
+                    for (m = 0; m < active; ++m) {
+                        u_prev[i * n_new + m] = u_prev[i * n + src[m]];
+                    }
+                    for (; m < n_new; ++m) { // pad with null steps of lane 0
+                        u_prev[i * n_new + m] = u_prev[i * n_new];
+                    }
+                    if (Tab::fsal) { // and stage 1 along with the state
+                        for (m = 0; m < active; ++m) {
+                            f[i * n_new + m] = f[i * n + src[m]];
+                        }
+                        for (; m < n_new; ++m) {
+                            f[i * n_new + m] = f[i * n_new];
+                        }
+                    }
+                }
+                for (m = active; m < n_new; ++m) {
+                    lane[m] = -1;
+                    t[m] = t[0];
+                    h[m] = 0;
+                }
+                n = n_new;
+            }
+        }
+    }
+
+    results_rkab<T> **results = new results_rkab<T>*[num];
+    for (int p = 0; p < num; ++p) {
+        results[p] = new_results_rkab(numsteps[p], numfailures[p],
+                                      tvec[p], u[p]);
+    }
+
+    // delete temporary arrays
+    delete [] t;
+    delete [] h;
+    delete [] hmin;
+    delete [] acc;
+    delete [] t_k;
+    delete [] ua;
+    delete [] ub;
+    delete [] u_k;
+    delete [] u_prev;
+    delete [] f;
+    // vectors are RAII; they'll be deleted automatically.
+
+    return results;
+}
+
+#endif // #include guard
@@ -0,0 +1,196 @@
+/** @file
+ * @brief Templates for adaptive step size Runge-Kutta solvers with a choice of
+ * step size control.
+ * @details Provides a template rkab_opt() which solves as rkab() does, but
+ * with the error measured in a norm weighted by absolute and relative
+ * tolerances, the first step estimated from the derivative (Hairer, Norsett
+ * and Wanner, Solving ODEs I, II.4), and the step size adapted by a PI or PID
+ * controller (Gustafsson; Soderlind), as chosen per call with rkab_options.
+ * The relative error of rkab() calls for tiny steps whenever a component
+ * crosses zero, and its plain controller tends to alternate between accepting
+ * and rejecting steps; these choices avoid both.
+ * @author Jeremiah O'Neil
+ * @copyright GNU Public License. */
+#ifndef INC_RKAB_CONTROL_hpp // #include guard
+#define INC_RKAB_CONTROL_hpp // ensure this file is included at most once per unit
+
+#include "rkab.hpp" // rkab_integrate_control, rkab_options, results_rkab
+
+/** @brief Class template for the step size control of rkab_opt().
+ * @details Satisfies the interface described by rkab_integrate_control().
+ * With the weighted error err of a step (acceptable if err <= 1) and of the
+ * last two accepted steps, the step size is adapted by the factor
+ * safety * err_n^(-b1/k) * err_(n-1)^(-b2/k) * err_(n-2)^(-b3/k), where k is
+ * the order of the method, limited to [1/5, 10] (to at most 1 right after a
+ * rejection). The integral controller has b = (1, 0, 0), the PI controller
+ * b = (0.7, -0.4, 0) (Gustafsson) and the PID controller b = (0.49, -0.34,
+ * 0.10) (Soderlind). The error of a rejected step adapts the step size by
+ * the integral controller, or halves it if the step was already rejected.
+ * @tparam T Floating-point compatible data type. */
+template<typename T>
+class rkab_pid_control
+{
+public:
+    rkab_pid_control(const rkab_options<T> &opts, int order) :
+        opts(opts), order(order), err1(1), err2(1), rejected(false)
+    {
+        static const T b[][3] = {{1, 0, 0}, {0.7, -0.4, 0},
+                                 {0.49, -0.34, 0.10}};
+        const int c = min(max(opts.controller, (int)RKAB_CONTROL_I),
+                          (int)RKAB_CONTROL_PID);
+        b1 = b[c][0] / order;
+        b2 = b[c][1] / order;
+        b3 = b[c][2] / order;
+    }
+
+    /// The magnitude of the first step, given or such that the local error
+    /// of an explicit Euler step, scaled to the order, is about 0.01.
+    T initial_step(int dim, T t, T t_end, const T *u, T *f0, T *u_tmp,
+                   T *f_tmp, void (*get_f)(T, T*, T*), bool &f0_valid)
+    {
+        if (opts.h0 > 0 || t == t_end) {
+            return min(opts.h0, abs(t_end - t));
+        }
+        get_f(t, const_cast<T *>(u), f0);
+        f0_valid = true;
+        // d0 = |u|, d1 = |f0| in the weights at u
+        T d0 = 0, d1 = 0;
+        for (int i = 0; i < dim; ++i) {
+            const T w = weight(i, u[i], u[i]);
+            d0 = accumulate(d0, ratio(u[i], w));
+            d1 = accumulate(d1, ratio(f0[i], w));
+        }
+        d0 = finish(dim, d0);
+        d1 = finish(dim, d1);
+        T h0 = (d0 < (T)1e-5 || d1 < (T)1e-5) ? (T)1e-6 : (T)0.01 * d0 / d1;
+        h0 = min(h0, abs(t_end - t));
+        // An explicit Euler step gives the second derivative
+        const T h_dir = (t_end >= t) ? h0 : -h0;
+        for (int i = 0; i < dim; ++i) {
+            u_tmp[i] = u[i] + h_dir * f0[i];
+        }
+        get_f(t + h_dir, u_tmp, f_tmp);
+        T d2 = 0;
+        for (int i = 0; i < dim; ++i) {
+            d2 = accumulate(d2, ratio(f_tmp[i] - f0[i],
+                                      weight(i, u[i], u[i])));
+        }
+        d2 = finish(dim, d2) / h0;
+        const T d = max(d1, d2);
+        const T h1 = (d <= (T)1e-15) ? max((T)1e-6, h0 * (T)1e-3)
+                                      : (T)pow(0.01 / d, 1.0 / order);
+        return min(100 * h0, h1);
+    }
+
+    /// The reciprocal of the weighted error of a step.
+    T acceptability(int dim, const T *u_prev, T *ua, T *ub)
+    {
+        T err = 0;
+        for (int i = 0; i < dim; ++i) {
+            err = accumulate(err, ratio(ua[i] - ub[i],
+                                        weight(i, u_prev[i], ub[i])));
+        }
+        return 1 / finish(dim, err);
+    }
+
+    /// The factor to adapt the step size by after an accepted step.
+    T accept(T acceptability)
+    {
+        const T err = max(1 / acceptability, (T)1e-10);
+        T adapt = safety * pow(err, -b1) * pow(err1, -b2) * pow(err2, -b3);
+        adapt = min(max(adapt, min_adapt), rejected ? (T)1 : max_adapt);
+        err2 = err1;
+        err1 = err;
+        rejected = false;
+        return adapt;
+    }
+
+    /// The factor to adapt the step size by after a rejected step, the first
+    /// of the step or not.
+    T reject(T acceptability, bool first)
+    {
+        rejected = true;
+        if (!first) {
+            return 0.5; // be pessimistic
+        }
+        return max(min_adapt,
+                   (T)(safety * pow(acceptability, (T)1 / order)));
+    }
+
+private:
+    /// The weight of component i, of states a and b at either end of a step.
+    T weight(int i, T a, T b) const
+    {
+        const T rtol = opts.rtols ? opts.rtols[i] : opts.rtol;
+        const T atol = opts.atols ? opts.atols[i] : opts.atol;
+        return atol + rtol * max(abs(a), abs(b));
+    }
+
+    /// x weighted by w, taking 0/0 as 0 (a zero weight needs no error).
+    static T ratio(T x, T w)
+    {
+        return (x == 0) ? 0 : x / w;
+    }
+
+    /// Add a weighted component to a norm.
+    T accumulate(T norm, T x) const
+    {
+        return (opts.norm == RKAB_NORM_MAX) ? max(norm, abs(x))
+                                            : norm + x * x;
+    }
+
+    /// Complete a norm of dim components.
+    T finish(int dim, T norm) const
+    {
+        return (opts.norm == RKAB_NORM_MAX) ? norm : sqrt(norm / dim);
+    }
+
+    const rkab_options<T> opts;
+    const int order;
+    static constexpr T safety = 0.9, max_adapt = 10, min_adapt = 0.2;
+    T b1, b2, b3; // controller coefficients, over the order
+    T err1, err2; // the errors of the last two accepted steps
+    bool rejected; // whether the last attempt was rejected
+};
+
+/// @cond IMPL
+template<typename T>
+constexpr T rkab_pid_control<T>::safety;
+template<typename T>
+constexpr T rkab_pid_control<T>::max_adapt;
+template<typename T>
+constexpr T rkab_pid_control<T>::min_adapt;
+/// @endcond
+
+/** @brief Function template for adaptive step size Runge-Kutta methods with a
+ * choice of step size control.
+ * @details Solves a given system over parameterized domain as rkab() does,
+ * with the error norm, tolerances, first step and controller given by
+ * rkab_options; see rkab_pid_control.
+ * @param u_init The initial state array of the system.
+ * @param dim The dimension of the system.
+ * @param maxsteps The maximum number of iterations to run.
+ * @param opts The options of the step size control.
+ * @param t The initial value of the system parameter.
+ * @param t_end The target value of the system parameter.
+ * @param get_f A callback function get_f(t, *u_t, *f) which writes the
+ * derivative of u at system parameter t and state u_t to array f.
+ * @tparam Tab Tableau type; see rkab_integrate().
+ * @tparam T Floating-point compatible data type. */
+template<class Tab, typename T>
+struct results_rkab<T> *rkab_opt(T *u_init, int dim, int maxsteps,
+                                 const rkab_options<T> *opts, T t, T t_end,
+                                 void (*get_f)(T, T*, T*))
+{
+    rkab_workspace<T> ws; // RAII; deleted automatically.
+    rkab_trajectory_output<T> out(ws, dim);
+    rkab_pid_control<T> ctl(*opts, Tab::order);
+    int numfailures;
+    int numsteps = rkab_integrate_control<Tab, T>(ws, u_init, dim, maxsteps,
+                                                  ctl, t, t_end, get_f, out,
+                                                  numfailures);
+    return new_results_rkab(numsteps, numfailures, out.tvec, out.u,
+                            ODE_STATS_OF(ws));
+}
+
+#endif // #include guard
@@ -0,0 +1,135 @@
+/** @file
+ * @brief Templates for adaptive step size Runge-Kutta solvers with dense
+ * output.
+ * @details Provides a template rkab_teval() which writes the solution only at
+ * requested values of the system parameter, interpolating within the accepted
+ * steps with hermite_interpolate(). The steps stay as large as the tolerance
+ * allows however fine the requested grid, and the memory returned scales with
+ * the grid rather than with the number of steps taken.
+ * @author Jeremiah O'Neil
+ * @copyright GNU Public License. */
+#ifndef INC_RKAB_DENSE_hpp // #include guard
+#define INC_RKAB_DENSE_hpp // ensure this file is included at most once per unit
+
+#include "rkab.hpp" // rkab_integrate, rkab_workspace, hermite_interpolate
+
+/** @brief Output policy of rkab_integrate() which writes the solution at
+ * requested parameter values.
+ * @details The values must be ordered in the direction of integration.
+ * Writes into arrays of n_eval rows held by the caller, and stops the
+ * integration once every value has been passed.
+ * @tparam T Floating-point compatible data type. */
+template<typename T>
+class rkab_teval_output
+{
+public:
+    rkab_teval_output(const T *t_eval, int n_eval, int dim, int t_dir,
+                      T *tarr, T *uarr) :
+        t_eval(t_eval), n_eval(n_eval), dim(dim), t_dir(t_dir),
+        tarr(tarr), uarr(uarr), next(0), numrows(0) {}
+
+    /** @brief Pass over the values before t, writing u_init at any equal
+     * to t.
+     * @return Whether there are values left. */
+    bool start(T t, const T *u_init)
+    {
+        for (; next < n_eval && t_dir * (t_eval[next] - t) <= 0; ++next) {
+            if (t_eval[next] == t) {
+                write(t, u_init);
+            }
+        }
+        return next < n_eval;
+    }
+
+    /// Write the values passed by accepted step n.
+    bool step(int, rkab_step<T> &s)
+    {
+        for (; next < n_eval && t_dir * (t_eval[next] - s.t1) <= 0; ++next) {
+            if (t_eval[next] == s.t1) {
+                write(s.t1, s.u1);
+            } else {
+                tarr[numrows] = t_eval[next];
+                hermite_interpolate(dim, s, t_eval[next],
+                                    &uarr[numrows * dim]);
+                ++numrows;
+            }
+        }
+        return next < n_eval;
+    }
+
+    /// Nothing to do; any values left lie beyond the last step.
+    void finish(int, T, const T *) {}
+
+    /// The number of rows written.
+    int rows() const
+    {
+        return numrows;
+    }
+
+private:
+    void write(T t, const T *u)
+    {
+        tarr[numrows] = t;
+        copy(u, u + dim, &uarr[numrows * dim]);
+        ++numrows;
+    }
+
+    const T *t_eval;
+    const int n_eval;
+    const int dim;
+    const int t_dir;
+    T *tarr, *uarr;
+    int next; // index of the next value of t_eval to pass
+    int numrows; // rows written
+};
+
+/** @brief Function template for adaptive step size Runge-Kutta methods with
+ * dense output.
+ * @details Solves a given system as rkab() does, but returns the solution at
+ * the values of t_eval in [t, t_end] only, interpolated with a cubic Hermite
+ * polynomial within each step. The interpolation is third order, so for the
+ * higher order methods its error dominates their local error on very smooth
+ * problems. The integration stops at the last value of t_eval.
+ * @param u_init The initial state array of the system.
+ * @param dim The dimension of the system.
+ * @param maxsteps The maximum number of iterations to run.
+ * @param tol The relative tolerance or a pointer to an array of relative
+ * tolerances for the local error of the system at each step.
+ * @param t The initial value of the system parameter.
+ * @param t_end The target value of the system parameter.
+ * @param get_f A callback function get_f(t, *u_t, *f) which writes the
+ * derivative of u at system parameter t and state u_t to array f.
+ * @param t_eval The values of the system parameter to write the solution at,
+ * ordered from t toward t_end.
+ * @param n_eval The number of values in t_eval.
+ * @return A results_rkab whose 'numsteps' is the number of rows written
+ * (fewer than n_eval if values lie outside [t, t_end] or maxsteps ran out)
+ * and whose arrays have room for n_eval rows.
+ * @tparam Tab Tableau type; see rkab_integrate().
+ * @tparam T Floating-point compatible data type.
+ * @tparam Ttol Tolerance type: should be (scalar) T or (array) T*. */
+template<class Tab, typename T, typename tolT>
+struct results_rkab<T> *rkab_teval(T *u_init, int dim, int maxsteps,
+                                   tolT tol, T t, T t_end,
+                                   void (*get_f)(T, T*, T*),
+                                   T *t_eval, int n_eval)
+{
+    rkab_workspace<T> ws; // RAII; deleted automatically.
+    results_rkab<T> *results = new results_rkab<T> {
+        0,
+        new T[max(n_eval, 1)], // time array
+        new T[max(n_eval, 1) * dim], // u array
+        0
+    };
+    rkab_teval_output<T> out(t_eval, n_eval, dim, (t_end >= t) ? 1 : -1,
+                             results->t, results->u);
+    if (out.start(t, u_init)) {
+        rkab_integrate<Tab, T, tolT>(ws, u_init, dim, maxsteps, tol, t, t_end,
+                                     get_f, out, results->numfailures);
+        results->stats = new_rkab_stats(ODE_STATS_OF(ws));
+    }
+    results->numsteps = out.rows();
+    return results;
+}
+
+#endif // #include guard
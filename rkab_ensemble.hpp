@@ -0,0 +1,71 @@
+/** @file
+ * @brief Templates for solving ensembles of problems across threads.
+ * @details Provides a template rkab_ensemble() which solves many independent
+ * initial value problems of one system with rkab(), each with its own initial
+ * state, domain and tolerance, on a work_stealing_pool. Each worker reuses its
+ * own rkab_workspace from problem to problem.
+ * @author Jeremiah O'Neil
+ * @copyright GNU Public License. */
+#ifndef INC_RKAB_ENSEMBLE_hpp // #include guard
+#define INC_RKAB_ENSEMBLE_hpp // ensure this file is included at most once per unit
+
+#include "rkab.hpp" // rkab, rkab_workspace, results_rkab
+#include "thread_pool.hpp" // work_stealing_pool
+
+/// Tolerance of problem p of an ensemble with one scalar tolerance each.
+template<typename T>
+T ensemble_tol(T *tol, int p, int, T)
+{
+    return tol[p];
+}
+
+/// Tolerance of problem p of an ensemble with an array of tolerances each.
+template<typename T>
+T *ensemble_tol(T *tol, int p, int dim, T *)
+{
+    return &tol[p * dim];
+}
+
+/** @brief Function template for solving an ensemble of initial value problems
+ * with an adaptive step size Runge-Kutta method across threads.
+ * @details Solves 'num' problems of a given system with rkab(), scheduling
+ * them on a work_stealing_pool so that workers finished with cheap problems
+ * take over the remaining problems of busy ones. Returns an array of pointers
+ * to results_rkab instances, one per problem.
+ * @param u_init The initial state arrays of the problems, concatenated.
+ * @param dim The dimension of the system.
+ * @param num The number of problems.
+ * @param maxsteps The maximum number of iterations to run per problem.
+ * @param tol The relative tolerances of the problems, one per problem or (for
+ * tolT a pointer) one array of 'dim' per problem, concatenated.
+ * @param t The initial values of the system parameter, one per problem.
+ * @param t_end The target values of the system parameter, one per problem.
+ * @param get_f A callback function get_f(t, *u_t, *f) which writes the
+ * derivative of u at system parameter t and state u_t to array f. It is called
+ * from several threads at once.
+ * @param numthreads The number of threads to use, or the number of hardware
+ * threads if not positive.
+ * @tparam Tab Tableau type; see rkab_integrate().
+ * @tparam T Floating-point compatible data type.
+ * @tparam Ttol Tolerance type of each problem: (scalar) T or (array) T*. */
+template<class Tab, typename T, typename tolT>
+results_rkab<T> **rkab_ensemble(T *u_init, int dim, int num, int maxsteps,
+                                T *tol, T *t, T *t_end,
+                                void (*get_f)(T, T*, T*), int numthreads)
+{
+    if (numthreads <= 0) {
+        numthreads = thread::hardware_concurrency();
+    }
+    results_rkab<T> **results = new results_rkab<T>*[num];
+    work_stealing_pool pool(max(1, min(numthreads, num)));
+    vector<rkab_workspace<T> > ws(pool.size()); // one per worker
+    pool.run(num, [&](int w, int p) {
+        results[p] = rkab<Tab, T, tolT>(ws[w], &u_init[p * dim], dim,
+                                        maxsteps,
+                                        ensemble_tol(tol, p, dim, tolT()),
+                                        t[p], t_end[p], get_f);
+    });
+    return results;
+}
+
+#endif // #include guard
@@ -0,0 +1,191 @@
+/** @file
+ * @brief Templates for adaptive step size Runge-Kutta solvers with event
+ * detection.
+ * @details Provides a template rkab_events_solve() which solves as rkab()
+ * does while watching event functions g(t, u) for sign changes. An event is
+ * located within the step where its function changes sign by root finding on
+ * the cubic Hermite interpolant of the step (see hermite_interpolate()), so
+ * it costs no derivative evaluations beyond one at the end of such a step.
+ * Terminal events stop the integration at the event, which ends the
+ * solution.
+ * @author Jeremiah O'Neil
+ * @copyright GNU Public License. */
+#ifndef INC_RKAB_EVENTS_hpp // #include guard
+#define INC_RKAB_EVENTS_hpp // ensure this file is included at most once per unit
+
+#include "rkab.hpp" // rkab_integrate, rkab_context, rkab_events
+
+/** @brief Output policy of rkab_integrate() which detects events, wrapping
+ * another output policy.
+ * @details Evaluates the event functions at the end of each accepted step
+ * and locates each sign change allowed by its direction by the Illinois
+ * method (regula falsi with halving) on the Hermite interpolant, to about
+ * 16 ulp of t. A zero counts as the new sign, so a function which only
+ * touches zero has an event there. If one of the events of a step is
+ * terminal, the step is cut short at the first of them, by overwriting the
+ * end of the step with the state there, and the integration stops.
+ * @tparam T Floating-point compatible data type.
+ * @tparam Inner The wrapped output policy type. */
+template<typename T, class Inner>
+class rkab_event_output
+{
+public:
+    rkab_event_output(rkab_events<T> &ev, int dim, Inner &inner) :
+        ev(ev), dim(dim), inner(inner), started(false), g0(ev.num),
+        g1(ev.num), gc(ev.num), uc(dim)
+    {
+        ev.count = 0;
+    }
+
+    /// Detect the events of accepted step n, then pass it on.
+    bool step(int n, rkab_step<T> &s)
+    {
+        if (!started) {
+            ev.get_g(s.t0, s.u0, g0.data());
+            started = true;
+        }
+        ev.get_g(s.t1, s.u1, g1.data());
+        // Locate the crossings of the step
+        roots.clear();
+        for (int i = 0; i < ev.num; ++i) {
+            const int dir = ev.direction ? ev.direction[i] : 0;
+            const bool rising = g0[i] < 0 && g1[i] >= 0;
+            const bool falling = g0[i] > 0 && g1[i] <= 0;
+            if ((rising && dir >= 0) || (falling && dir <= 0)) {
+                roots.push_back(make_pair(locate(s, i), i));
+            }
+        }
+        const T t_dir = (s.t1 >= s.t0) ? 1 : -1;
+        sort(roots.begin(), roots.end(),
+             [t_dir](const pair<T, int> &a, const pair<T, int> &b) {
+                 return t_dir * a.first < t_dir * b.first;
+             });
+        // Report them in order, up to the first terminal one
+        bool stop = false;
+        for (size_t r = 0; r < roots.size() && !stop; ++r) {
+            const T t_root = roots[r].first;
+            const int i = roots[r].second;
+            hermite_interpolate(dim, s, t_root, uc.data());
+            record(t_root, uc.data(), i);
+            stop = ev.terminal && ev.terminal[i];
+            if (stop) { // end the step at the event
+                copy(uc.begin(), uc.end(), s.u1);
+                s.t1 = t_root;
+                s.f_end = 0; // the derivative at the old end is no more
+            }
+        }
+        swap(g0, g1);
+        return inner.step(n, s) && !stop;
+    }
+
+    /// Pass the end of the integration on.
+    void finish(int n, T t, const T *u)
+    {
+        inner.finish(n, t, u);
+    }
+
+private:
+    /// The root of event function i within step s, by the Illinois method.
+    T locate(rkab_step<T> &s, int i)
+    {
+        T lo = s.t0, hi = s.t1, glo = g0[i], ghi = g1[i];
+        if (ghi == 0) {
+            return hi;
+        }
+        const T tol = 16 * boost::math::ulp(max(abs(s.t0), abs(s.t1)));
+        int side = 0; // which end moved last: -1 lo, 1 hi
+        for (int it = 0; it < 200 && abs(hi - lo) > tol; ++it) {
+            T c = (glo * hi - ghi * lo) / (glo - ghi); // secant
+            if (!(t_between(c, lo, hi))) {
+                c = lo + (hi - lo) / 2;
+            }
+            hermite_interpolate(dim, s, c, uc.data());
+            ev.get_g(c, uc.data(), gc.data());
+            if (gc[i] == 0) {
+                return c;
+            }
+            if ((gc[i] > 0) == (glo > 0)) {
+                lo = c;
+                glo = gc[i];
+                if (side == -1) {
+                    ghi /= 2; // Illinois: don't let hi stagnate
+                }
+                side = -1;
+            } else {
+                hi = c;
+                ghi = gc[i];
+                if (side == 1) {
+                    glo /= 2;
+                }
+                side = 1;
+            }
+        }
+        return hi; // the end past the crossing
+    }
+
+    /// Whether c lies strictly between a and b.
+    static bool t_between(T c, T a, T b)
+    {
+        return (a < b) ? (a < c && c < b) : (b < c && c < a);
+    }
+
+    /// Write an event to the buffers, if they have room.
+    void record(T t, const T *u, int i)
+    {
+        if (ev.count < ev.capacity) {
+            ev.t[ev.count] = t;
+            if (ev.u) {
+                copy(u, u + dim, &ev.u[ev.count * dim]);
+            }
+            if (ev.which) {
+                ev.which[ev.count] = i;
+            }
+        }
+        ++ev.count;
+    }
+
+    rkab_events<T> &ev;
+    const int dim;
+    Inner &inner;
+    bool started; // whether g0 has been evaluated
+    vector<T> g0, g1, gc; // event values at the ends of the step, and a probe
+    vector<T> uc; // interpolated state
+    vector<pair<T, int> > roots; // crossings of the step: time and event
+};
+
+/** @brief Function template for adaptive step size Runge-Kutta methods with
+ * event detection.
+ * @details Solves a given system as rkab() does, reporting the events
+ * described by 'ev' to it, and stopping at the first terminal event, which is
+ * then the last step of the solution.
+ * @param u_init The initial state array of the system.
+ * @param dim The dimension of the system.
+ * @param maxsteps The maximum number of iterations to run.
+ * @param tol The relative tolerance or a pointer to an array of relative
+ * tolerances for the local error of the system at each step.
+ * @param t The initial value of the system parameter.
+ * @param t_end The target value of the system parameter.
+ * @param get_f A callback function get_f(t, *u_t, *f) which writes the
+ * derivative of u at system parameter t and state u_t to array f.
+ * @param ev The event functions and the buffers to report events to.
+ * @tparam Tab Tableau type; see rkab_integrate().
+ * @tparam T Floating-point compatible data type.
+ * @tparam Ttol Tolerance type: should be (scalar) T or (array) T*. */
+template<class Tab, typename T, typename tolT>
+struct results_rkab<T> *rkab_events_solve(T *u_init, int dim, int maxsteps,
+                                          tolT tol, T t, T t_end,
+                                          void (*get_f)(T, T*, T*),
+                                          rkab_events<T> *ev)
+{
+    rkab_context<T> ctx(dim, 0); // RAII; deleted automatically.
+    rkab_trajectory_output<T> traj(ctx.ws, dim);
+    rkab_event_output<T, rkab_trajectory_output<T> > out(*ev, dim, traj);
+    int numfailures;
+    int numsteps = rkab_integrate<Tab, T, tolT>(ctx.ws, u_init, dim,
+                                                maxsteps, tol, t, t_end,
+                                                get_f, out, numfailures);
+    return new_results_rkab(numsteps, numfailures, ctx.ws.tvec, ctx.ws.u,
+                            ODE_STATS_OF(ctx.ws));
+}
+
+#endif // #include guard
@@ -0,0 +1,215 @@
+/** @file
+ * @brief Templates for mixed-precision adaptive step size Runge-Kutta
+ * solvers.
+ * @details Provides a template rkab_mixed() which evaluates the stages, and
+ * the derivative callback, in a narrow data type (eg., float) but keeps the
+ * parameter and the accepted state in a wide one (eg., double). In the narrow
+ * type alone, long runs drift: each step adds an increment to a state and
+ * parameter much larger than it, losing most of the increment's bits, and the
+ * minimal step size grows with the parameter. Here each step forms its
+ * increment h * sum_j b_j f_j in the narrow type, where it is small and loses
+ * nothing, and adds it to the wide state; the step size is rounded to the
+ * narrow type, so that the parameter advances by exactly the step the stages
+ * were taken with. The stage arithmetic and the memory it streams through
+ * are those of the narrow type, so it vectorizes twice as wide as the wide
+ * type's; the accuracy is limited only by that of the derivative evaluated in
+ * the narrow type.
+ * @author Jeremiah O'Neil
+ * @copyright GNU Public License. */
+#ifndef INC_RKAB_MIXED_hpp // #include guard
+#define INC_RKAB_MIXED_hpp // ensure this file is included at most once per unit
+
+#include "rkab.hpp" // rkab_sum, rkab_tol_control, results_rkab
+
+/** @brief Difference of the low- and high-order weights of stage j.
+ * @details Summing the difference of the weights, rather than differencing
+ * the two sums, keeps the error estimate clear of the rounding of the
+ * narrow type, which is as large as the estimate at tight tolerances.
+ * @tparam Tab Tableau type; see rkab_integrate(). */
+template<class Tab>
+constexpr long double tableau_be(int j)
+{
+    return tableau_ba<Tab>(j) - tableau_bb<Tab>(j);
+}
+
+/** @brief Template for the stages of one step of an rkab_mixed() method.
+ * @details As rkab_stage in the narrow type TF, but the last pass adds the
+ * high-order increment to the wide state u_prev, forms the low-order state
+ * from the high-order one and the error estimate (see tableau_be()), and
+ * rounds the high-order state to the narrow type for the stages of the next
+ * step.
+ * @tparam Tab Tableau type; see rkab_integrate().
+ * @tparam TS Wide (state) floating-point compatible data type.
+ * @tparam TF Narrow (stage) floating-point compatible data type.
+ * @tparam k The stage whose derivative has just been evaluated. */
+template<class Tab, typename TS, typename TF, int k = 0,
+         bool last = (k == Tab::bstages - 1)>
+struct rkab_mixed_stage
+{
+    static void advance(int dim, TS t, TF h, TS *ua, TS *ub, TF *ub_f,
+                        TF *u_k, const TS *u_prev, const TF *u_prev_f, TF *f,
+                        void (*get_f)(TF, TF*, TF*))
+    {
+        for (int i = 0; i < dim; ++i){
+            TF s = 0;
+            rkab_sum<Tab, TF, tableau_a_row<Tab, k>, 0, k>::add(s, f, dim, i);
+            u_k[i] = u_prev_f[i] + h * s;
+        }
+        get_f((TF)(t + h * (TS)Tab::c[k]), u_k, &f[(k + 1) * dim]);
+        rkab_mixed_stage<Tab, TS, TF, k + 1>::advance(dim, t, h, ua, ub, ub_f,
+                                                      u_k, u_prev, u_prev_f,
+                                                      f, get_f);
+    }
+};
+
+/// @cond IMPL
+template<class Tab, typename TS, typename TF, int k>
+struct rkab_mixed_stage<Tab, TS, TF, k, true>
+{
+    static void advance(int dim, TS, TF h, TS *ua, TS *ub, TF *ub_f, TF *,
+                        const TS *u_prev, const TF *, TF *f,
+                        void (*)(TF, TF*, TF*))
+    { // add the increments to the wide state
+        for (int i = 0; i < dim; ++i){
+            TF sb = 0, se = 0;
+            rkab_sum<Tab, TF, tableau_bb<Tab>, 0, k>::add(sb, f, dim, i);
+            rkab_sum<Tab, TF, tableau_be<Tab>, 0, k>::add(se, f, dim, i);
+            ub[i] = u_prev[i] + (TS)(h * sb);
+            ua[i] = ub[i] + (TS)(h * se);
+            ub_f[i] = (TF)ub[i];
+        }
+    }
+};
+/// @endcond
+
+/** @brief Function template for mixed-precision adaptive step size
+ * Runge-Kutta methods.
+ * @details Solves a given system over parameterized domain as rkab() does,
+ * with the step size control of rkab_tol_control in the wide type, but with
+ * the stages in the narrow type; see the file description. The trajectory is
+ * returned in the wide type.
+ * @param u_init The initial state array of the system.
+ * @param dim The dimension of the system.
+ * @param maxsteps The maximum number of iterations to run.
+ * @param tol The relative tolerance or a pointer to an array of relative
+ * tolerances for the local error of the system at each step.
+ * @param t The initial value of the system parameter.
+ * @param t_end The target value of the system parameter.
+ * @param get_f A callback function get_f(t, *u_t, *f) in the narrow type
+ * which writes the derivative of u at system parameter t and state u_t to
+ * array f.
+ * @tparam Tab Tableau type; see rkab_integrate().
+ * @tparam TS Wide (state) floating-point compatible data type.
+ * @tparam TF Narrow (stage) floating-point compatible data type.
+ * @tparam Ttol Tolerance type: should be (scalar) TS or (array) TS*. */
+template<class Tab, typename TS, typename TF, typename tolT>
+struct results_rkab<TS> *rkab_mixed(TS *u_init, int dim, int maxsteps,
+                                    tolT tol, TS t, TS t_end,
+                                    void (*get_f)(TF, TF*, TF*))
+{
+    const int bstages = Tab::bstages;
+    // Narrow: stage derivatives, stage state, state and high-order state;
+    // wide: state and low- and high-order states
+    vector<TF> block_f((bstages + 3) * (size_t)dim);
+    vector<TS> block_s(3 * (size_t)dim);
+    TF *f = block_f.data();
+    TF *u_k = f + bstages * dim;
+    TF *u_prev_f = u_k + dim;
+    TF *ub_f = u_prev_f + dim;
+    TS *u_prev = block_s.data();
+    TS *ua = u_prev + dim;
+    TS *ub = ua + dim;
+    const TF *f_last = &f[(bstages - 1) * dim];
+    // The output arena and statistics; the stage arrays are those above
+    rkab_workspace<TS> ws; // RAII; deleted automatically.
+    rkab_tol_control<TS, tolT> ctl(tol, Tab::order);
+
+    // Initialize
+    int numfailures = 0;
+    int numsteps = 0;
+    bool f0_valid = false; // whether f holds stage 1 at (t, u_prev)
+    for (int i = 0; i < dim; ++i) {
+        u_prev[i] = u_init[i];
+        u_prev_f[i] = (TF)u_init[i];
+    }
+    { // the probe accounts the time of the solve on leaving this scope
+        ODE_STATS(rkab_probe<TF> probe(ws.stats, get_f); get_f = probe.get_f();)
+
+        // Guess an initial step size; rkab_tol_control needs no derivatives
+        TS h = ctl.initial_step(dim, t, t_end, u_prev, 0, 0, 0, 0, f0_valid);
+        int t_dir = (t_end >= t) ? 1 : -1;
+        h *= t_dir;
+
+        // Main loop
+        while (numsteps < maxsteps && t_dir * (t_end - t) > 0)
+        {
+            bool failures = false;
+            ODE_STATS(long pessimistic = 0;) // rejections since the first
+            // The minimal step size is that of the wide parameter
+            TS hmin = 16 * boost::math::ulp(t);
+            if (abs(h) < hmin) {
+                h = t_dir * hmin;
+            }
+            bool last = false; // whether the step ends at t_end
+            if (t_dir * (t_end - t - h) <= 0){
+                h = t_end - t;
+                last = true;
+            }
+
+            // Loop for advancing one step
+            while (true)
+            {
+                // The parameter advances by the step the stages take exactly
+                const TF h_f = (TF)h;
+                if (!f0_valid) {
+                    get_f((TF)t, u_prev_f, f);
+                    f0_valid = true;
+                }
+                rkab_mixed_stage<Tab, TS, TF>::advance(dim, t, h_f, ua, ub,
+                                                       ub_f, u_k, u_prev,
+                                                       u_prev_f, f, get_f);
+
+                TS acceptability = ctl.acceptability(dim, u_prev, ua, ub);
+                if (acceptability > 1 || abs(h) <= hmin)
+                { // Accept the step
+                    ++numsteps;
+                    ODE_STATS(ws.stats.numhmin += !(acceptability > 1);
+                              rkab_stats_step(ws.stats, h);)
+                    t = last ? t_end : t + (TS)h_f;
+                    ws.tvec.push_back(t);
+                    ws.u.insert(ws.u.end(), ub, ub + dim);
+                    // An FSAL tableau's last stage was evaluated at ub_f, to
+                    // within rounding
+                    f0_valid = Tab::fsal;
+                    if (f0_valid) {
+                        copy(f_last, f_last + dim, f);
+                    }
+                    swap(u_prev, ub);
+                    swap(u_prev_f, ub_f);
+                    h *= ctl.accept(acceptability);
+                    break;
+                }
+                else
+                { // Reject the step
+                    ODE_STATS(++ws.stats.numrejections;)
+                    last = false;
+                    if (!failures)
+                    {
+                        failures = true;
+                        ++numfailures;
+                        h *= ctl.reject(acceptability, true);
+                    } else {
+                        h *= ctl.reject(acceptability, false);
+                        ODE_STATS(++ws.stats.numpessimistic;
+                                  ws.stats.maxpessimistic = max(
+                                      ws.stats.maxpessimistic, ++pessimistic);)
+                    }
+                }
+            }
+        }
+    }
+    return new_results_rkab(numsteps, numfailures, ws.tvec, ws.u,
+                            ODE_STATS_OF(ws));
+}
+
+#endif // #include guard
@@ -0,0 +1,373 @@
+/** @file
+ * @brief Templates for multirate adaptive step size Runge-Kutta solvers.
+ * @details Provides a template rkab_multirate() for systems whose components
+ * split into a few fast ones, the first dim_fast, and many slow ones, the
+ * rest, with a derivative callback for each partition. Each step is first
+ * taken by the method over the whole system, its size controlled by the
+ * error of the slow partition alone. Where the fast partition is then out of
+ * tolerance, it alone is solved over the step again in adaptive sub-steps of
+ * its own, the slow components following the cubic Hermite interpolant of
+ * their step (see hermite_interpolate()), so that the slow derivative is
+ * evaluated once per stage of a step however many sub-steps the fast
+ * components take. This is the compound step with local refinement of
+ * Savcenco, Hundsdorfer and Verwer; it assumes that the slow components are
+ * not too sensitive to the fast ones within a step.
+ * @author Jeremiah O'Neil
+ * @copyright GNU Public License. */
+#ifndef INC_RKAB_MULTIRATE_hpp // #include guard
+#define INC_RKAB_MULTIRATE_hpp // ensure this file is included at most once per unit
+
+#include "rkab.hpp" // rkab_sum, rkab_workspace, rkab_tol_control
+
+/** @brief Structure template of the derivative of the whole system for
+ * rkab_multirate(): that of each partition, into the same array.
+ * @tparam T Floating-point compatible data type. */
+template<typename T>
+struct rkab_multirate_f
+{
+    void (*get_f_fast)(T, T*, T*); ///< Callback for the fast partition
+    void (*get_f_slow)(T, T*, T*); ///< Callback for the slow partition
+
+    void operator()(T t, T *u, T *f)
+    {
+        get_f_fast(t, u, f);
+        slow(t, u, f);
+    }
+
+    /// Call the slow callback alone, timed and counted if instrumented.
+    void slow(T t, T *u, T *f)
+    {
+        ODE_STATS(rkab_probe<T>::timed([&]() { get_f_slow(t, u, f); });
+                  return;)
+        get_f_slow(t, u, f);
+    }
+};
+
+/** @brief Structure template of the derivative of the fast partition within
+ * a step of rkab_multirate().
+ * @details Fills in the slow components of the state by interpolation
+ * within their step before calling the fast callback.
+ * @tparam T Floating-point compatible data type. */
+template<typename T>
+struct rkab_multirate_fast_f
+{
+    int dim_fast; ///< The dimension of the fast partition
+    int dim_slow; ///< The dimension of the slow partition
+    rkab_step<T> slow; ///< The step of the slow partition
+    void (*get_f_fast)(T, T*, T*); ///< Callback for the fast partition
+
+    void operator()(T t, T *u, T *f)
+    {
+        hermite_interpolate(dim_slow, slow, t, u + dim_fast);
+        get_f_fast(t, u, f);
+    }
+};
+
+/** @brief Template for the stages of one step of rkab_multirate().
+ * @details As rkab_stage, forming the first n elements of each stage, whose
+ * derivatives lie 'stride' apart, and with any callable derivative.
+ * @tparam Tab Tableau type; see rkab_integrate().
+ * @tparam T Floating-point compatible data type.
+ * @tparam k The stage whose derivative has just been evaluated. */
+template<class Tab, typename T, int k = 0,
+         bool last = (k == Tab::bstages - 1)>
+struct rkab_multirate_stage
+{
+    template<class Deriv>
+    static void advance(int n, int stride, T t, T h, T *ua, T *ub, T *u_k,
+                        const T *u_prev, T *f, Deriv &deriv)
+    {
+        for (int i = 0; i < n; ++i){
+            T s = 0;
+            rkab_sum<Tab, T, tableau_a_row<Tab, k>, 0, k>::add(s, f, stride,
+                                                               i);
+            u_k[i] = u_prev[i] + h * s;
+        }
+        deriv(t + h * (T)Tab::c[k], u_k, &f[(k + 1) * stride]);
+        rkab_multirate_stage<Tab, T, k + 1>::advance(n, stride, t, h, ua, ub,
+                                                     u_k, u_prev, f, deriv);
+    }
+};
+
+/// @cond IMPL
+template<class Tab, typename T, int k>
+struct rkab_multirate_stage<Tab, T, k, true>
+{
+    template<class Deriv>
+    static void advance(int n, int stride, T, T h, T *ua, T *ub, T *,
+                        const T *u_prev, T *f, Deriv &)
+    { // combine the stages into the low- and high-order states
+        for (int i = 0; i < n; ++i){
+            T sa = 0, sb = 0;
+            rkab_sum<Tab, T, tableau_ba<Tab>, 0, k>::add(sa, f, stride, i);
+            rkab_sum<Tab, T, tableau_bb<Tab>, 0, k>::add(sb, f, stride, i);
+            ua[i] = u_prev[i] + h * sa;
+            ub[i] = u_prev[i] + h * sb;
+        }
+    }
+};
+/// @endcond
+
+/** @brief Function template for the sub-steps of the fast partition over a
+ * step of rkab_multirate().
+ * @details Solves the fast partition from the start to the end of step s of
+ * the whole system, writing its final state to the fast components of s.u1.
+ * Its rejected sub-steps count as failures of neither the step nor the solve.
+ * @param ctl The step size control.
+ * @param dim The dimension of the system.
+ * @param dim_fast The dimension of the fast partition.
+ * @param s The step of the whole system, with its derivatives at both ends
+ * (only the slow components are needed at the end).
+ * @param h [in,out] The size of the first sub-step, and of the next.
+ * @param f Stage derivatives of the fast partition, stages * dim_fast.
+ * @param ua, ub, u_prev Fast partition arrays of a sub-step.
+ * @param u_k A state array of the whole system.
+ * @param get_f_fast The callback for the fast partition.
+ * @tparam Tab Tableau type; see rkab_integrate().
+ * @tparam T Floating-point compatible data type.
+ * @tparam Ttol Tolerance type: should be (scalar) T or (array) T*. */
+template<class Tab, typename T, typename tolT>
+void rkab_multirate_substeps(rkab_tol_control<T, tolT> &ctl, int dim,
+                            int dim_fast, rkab_step<T> &s, T &h, T *f,
+                            T *ua, T *ub, T *u_prev, T *u_k,
+                            void (*get_f_fast)(T, T*, T*))
+{
+    const T *f_last = &f[(Tab::bstages - 1) * dim_fast];
+    rkab_step<T> slow = {s.t0, s.t1, s.u0 + dim_fast, s.u1 + dim_fast,
+                         s.f0 + dim_fast, s.f_end + dim_fast, 0, 0};
+    rkab_multirate_fast_f<T> deriv = {dim_fast, dim - dim_fast, slow,
+                                      get_f_fast};
+    T t = s.t0;
+    int t_dir = (s.t1 >= s.t0) ? 1 : -1;
+    copy(s.u0, s.u0 + dim_fast, u_prev);
+    copy(s.f0, s.f0 + dim_fast, f); // stage 1 is that of the whole step
+
+    while (t_dir * (s.t1 - t) > 0)
+    {
+        bool failures = false;
+        T hmin = 16 * boost::math::ulp(t);
+        if (abs(h) < hmin) {
+            h = t_dir * hmin;
+        }
+        T h_free = h; // the size to carry on with, if cut to end the step
+        bool last = t_dir * (s.t1 - t - h) <= 0;
+        if (last){
+            h = s.t1 - t;
+        }
+
+        while (true)
+        {
+            rkab_multirate_stage<Tab, T>::advance(dim_fast, dim_fast, t, h,
+                                                  ua, ub, u_k, u_prev, f,
+                                                  deriv);
+            T acceptability = ctl.acceptability_block(0, dim_fast, ua, ub);
+            if (acceptability > 1 || abs(h) <= hmin)
+            { // Accept the sub-step
+                t = last ? s.t1 : t + h;
+                swap(u_prev, ub);
+                if (Tab::fsal) {
+                    copy(f_last, f_last + dim_fast, f);
+                } else if (!last) {
+                    copy(u_prev, u_prev + dim_fast, u_k);
+                    deriv(t, u_k, f);
+                }
+                h *= ctl.accept(acceptability);
+                if (last && !failures && abs(h_free) > abs(h)) {
+                    h = h_free;
+                }
+                break;
+            }
+            else
+            { // Reject the sub-step
+                last = false;
+                h *= ctl.reject(acceptability, !failures);
+                failures = true;
+            }
+        }
+    }
+    copy(u_prev, u_prev + dim_fast, s.u1);
+}
+
+/** @brief Structure template of the stage policy of rkab_multirate().
+ * @details Satisfies the interface described by rkab_integrate_stages(), as
+ * rkab_stages does, with the derivative of the whole system that of each
+ * partition (see rkab_multirate_f); the callback given to the loop is that
+ * of the fast partition.
+ * @tparam Tab Tableau type; see rkab_integrate().
+ * @tparam T Floating-point compatible data type. */
+template<class Tab, typename T>
+struct rkab_multirate_stages
+{
+    void (*get_f_slow)(T, T*, T*); ///< Callback for the slow partition
+
+    void derivative(T t, T *u, T *f, void (*get_f)(T, T*, T*))
+    {
+        rkab_multirate_f<T> deriv = {get_f, get_f_slow};
+        deriv(t, u, f);
+    }
+
+    void advance(int dim, T t, T h, T *ua, T *ub, T *u_k, const T *u_prev,
+                 T *f, void (*get_f)(T, T*, T*))
+    {
+        rkab_multirate_f<T> deriv = {get_f, get_f_slow};
+        rkab_multirate_stage<Tab, T>::advance(dim, dim, t, h, ua, ub, u_k,
+                                              u_prev, f, deriv);
+    }
+
+    void copy(int dim, const T *from, T *to)
+    {
+        std::copy(from, from + dim, to);
+    }
+};
+
+/** @brief Class template for the step size control of rkab_multirate().
+ * @details That of rkab_tol_control, with the acceptability of a step that
+ * of the slow partition alone. That of the fast partition is measured too,
+ * for rkab_multirate_output to decide whether to take sub-steps.
+ * @tparam T Floating-point compatible data type.
+ * @tparam Ttol Tolerance type: should be (scalar) T or (array) T*. */
+template<typename T, typename tolT>
+class rkab_multirate_control : public rkab_tol_control<T, tolT>
+{
+public:
+    rkab_multirate_control(tolT tol, int order, int dim_fast) :
+        rkab_tol_control<T, tolT>(tol, order), dim_fast(dim_fast),
+        acc_fast(0) {}
+
+    /// As rkab_tol_control::acceptability(), of the slow partition.
+    T acceptability(int dim, const T *, T *ua, T *ub)
+    {
+        acc_fast = this->acceptability_block(0, dim_fast, ua, ub);
+        return this->acceptability_block(dim_fast, dim, ua, ub);
+    }
+
+    /// The acceptability of the fast partition over the last attempt.
+    T fast() const
+    {
+        return acc_fast;
+    }
+
+private:
+    const int dim_fast;
+    T acc_fast;
+};
+
+/** @brief Output policy of rkab_integrate_stages() which takes the fast
+ * partition of an accepted step again in sub-steps where it is out of
+ * tolerance, wrapping another output policy.
+ * @details Overwrites the fast components of the end of the step with the
+ * result of rkab_multirate_substeps(), then passes the step on. The
+ * derivative at the end of the step no longer matches its state, so it is
+ * then left unknown, to be evaluated anew as the first stage of the next.
+ * @tparam Tab Tableau type; see rkab_integrate().
+ * @tparam T Floating-point compatible data type.
+ * @tparam Ttol Tolerance type: should be (scalar) T or (array) T*.
+ * @tparam Inner The wrapped output policy type. */
+template<class Tab, typename T, typename tolT, class Inner>
+class rkab_multirate_output
+{
+public:
+    rkab_multirate_output(rkab_multirate_control<T, tolT> &ctl, int dim,
+                          int dim_fast, void (*get_f_slow)(T, T*, T*),
+                          Inner &inner) :
+        ctl(ctl), dim(dim), dim_fast(dim_fast), get_f_slow(get_f_slow),
+        inner(inner), h_fast(0),
+        sub((Tab::bstages + 3) * (size_t)dim_fast + dim) {}
+
+    /// Refine the fast partition of accepted step n if need be, then pass
+    /// it on.
+    bool step(int n, rkab_step<T> &s)
+    {
+        const T h = s.t1 - s.t0;
+        const T acc_fast = ctl.fast();
+        if (!(acc_fast > 1 || abs(h) <= 16 * boost::math::ulp(s.t0)))
+        {
+            if (!s.f_end) { // the slow derivative at the end
+                rkab_multirate_f<T> deriv = {s.get_f, get_f_slow};
+                deriv.slow(s.t1, s.u1, s.f_buf);
+                s.f_end = s.f_buf;
+            }
+            if (h_fast == 0 || abs(h_fast) > abs(h)) { // guess from the error
+                h_fast = h * (T)pow(acc_fast, (T)1 / Tab::order);
+            }
+            // Sub-step stages and states, and a whole state
+            T *f_sub = sub.data();
+            T *ua_sub = f_sub + Tab::bstages * dim_fast;
+            T *ub_sub = ua_sub + dim_fast;
+            T *u_prev_sub = ub_sub + dim_fast;
+            T *u_k_sub = u_prev_sub + dim_fast;
+            rkab_multirate_substeps<Tab, T, tolT>(ctl, dim, dim_fast, s,
+                                                  h_fast, f_sub, ua_sub,
+                                                  ub_sub, u_prev_sub, u_k_sub,
+                                                  s.get_f);
+            s.f_end = 0; // the last stage saw the old fast state
+        }
+        return inner.step(n, s);
+    }
+
+    /// Pass the end of the integration on.
+    void finish(int n, T t, const T *u)
+    {
+        inner.finish(n, t, u);
+    }
+
+private:
+    rkab_multirate_control<T, tolT> &ctl;
+    const int dim, dim_fast;
+    void (*const get_f_slow)(T, T*, T*);
+    Inner &inner;
+    T h_fast; // the size of the next sub-step, or 0 before the first
+    vector<T> sub; // the memory of the sub-steps
+};
+
+/** @brief Function template for multirate adaptive step size Runge-Kutta
+ * methods.
+ * @details Solves a given system, partitioned into fast and slow components,
+ * over parameterized domain to given relative tolerance in local error; see
+ * the file description. Runs rkab_integrate_stages() with
+ * rkab_multirate_stages, rkab_multirate_control and rkab_multirate_output.
+ * Dynamically allocates memory for the solution, at each step of the whole
+ * system, and returns a pointer to a results_rkab instance containing that
+ * solution. Its failures, and its statistics if instrumented, are those of
+ * the steps of the whole system, with the calls of either callback counted
+ * as derivative evaluations, and the time of the sub-steps (less their
+ * derivatives) counted as output.
+ * @param u_init The initial state array of the system.
+ * @param dim The dimension of the system.
+ * @param dim_fast The number of fast components, which come first.
+ * @param maxsteps The maximum number of iterations (of the whole system) to
+ * run.
+ * @param tol The relative tolerance or a pointer to an array of relative
+ * tolerances for the local error of the system at each step.
+ * @param t The initial value of the system parameter.
+ * @param t_end The target value of the system parameter.
+ * @param get_f_fast A callback function get_f_fast(t, *u_t, *f) which writes
+ * the derivative of the fast components of u (elements 0 through dim_fast -
+ * 1) at system parameter t and state u_t to array f.
+ * @param get_f_slow A callback function get_f_slow(t, *u_t, *f) which writes
+ * the derivative of the slow components of u (elements dim_fast through dim
+ * - 1) at system parameter t and state u_t to array f.
+ * @tparam Tab Tableau type; see rkab_integrate().
+ * @tparam T Floating-point compatible data type.
+ * @tparam Ttol Tolerance type: should be (scalar) T or (array) T*. */
+template<class Tab, typename T, typename tolT>
+struct results_rkab<T> *rkab_multirate(T *u_init, int dim, int dim_fast,
+                                       int maxsteps, tolT tol, T t, T t_end,
+                                       void (*get_f_fast)(T, T*, T*),
+                                       void (*get_f_slow)(T, T*, T*))
+{
+    rkab_multirate_stages<Tab, T> stages = {get_f_slow};
+    rkab_multirate_control<T, tolT> ctl(tol, Tab::order, dim_fast);
+    rkab_workspace<T> ws; // RAII; deleted automatically.
+    rkab_trajectory_output<T> traj(ws, dim);
+    rkab_multirate_output<Tab, T, tolT, rkab_trajectory_output<T> >
+        out(ctl, dim, dim_fast, get_f_slow, traj);
+    int numfailures;
+    int numsteps = rkab_integrate_stages<Tab, T>(ws, stages, u_init, dim,
+                                                 maxsteps, ctl, t, t_end,
+                                                 get_f_fast, out, numfailures);
+    return new_results_rkab(numsteps, numfailures, ws.tvec, ws.u,
+                            ODE_STATS_OF(ws));
+}
+
+#endif // #include guard
@@ -0,0 +1,273 @@
+/** @file
+ * @brief Templates for adaptive step size Runge-Kutta solvers which write
+ * their output to disk.
+ * @details Provides a template rkab_npy() which writes the accepted steps of
+ * rkab_integrate() as they are taken to two files in NumPy's .npy format, one
+ * of the parameter and one of the state, through a window of memory mapped
+ * a chunk at a time. The memory used is independent of the number of steps
+ * taken, so runs can outgrow memory; the files can be loaded without a copy
+ * by numpy.load(path, mmap_mode='r'). POSIX only.
+ * @author Jeremiah O'Neil
+ * @copyright GNU Public License. */
+#ifndef INC_RKAB_NPY_hpp // #include guard
+#define INC_RKAB_NPY_hpp // ensure this file is included at most once per unit
+
+#include "rkab.hpp" // rkab_integrate, rkab_workspace
+#include <cstdio> // for snprintf
+#include <cstring> // for memcpy, memset
+#include <fcntl.h> // for open, posix_fallocate
+#include <sys/mman.h> // for mmap
+#include <unistd.h> // for ftruncate, sysconf
+
+/// The size of the .npy header written, which leaves room for any shape
+#define NPY_HEADER_SIZE 128
+/// The size of the window of a file mapped at once, and of its growth
+#define NPY_CHUNK_SIZE (16 << 20)
+
+/** @brief Type traits giving the .npy type descriptor of a data type.
+ * @details Long double is x86 extended precision padded to 16 bytes, which
+ * NumPy knows as float128 (longdouble) on such platforms. */
+template<typename T>
+struct npy_descr;
+/// @cond IMPL
+template<> struct npy_descr<float>
+{
+    static const char *kind() { return "f4"; }
+};
+template<> struct npy_descr<double>
+{
+    static const char *kind() { return "f8"; }
+};
+template<> struct npy_descr<long double>
+{
+    static const char *kind() { return "f16"; }
+};
+/// @endcond
+
+/** @brief Class template writing a C-ordered array to a .npy file, one row at
+ * a time, through a memory mapped window.
+ * @details The header is written with a placeholder shape and patched with
+ * the number of rows on close(). The file grows a chunk at a time, and only
+ * the chunk being written is mapped, so the memory resident for the file
+ * stays under two chunks. Writes fail silently once an operation has failed;
+ * see ok().
+ * @tparam T Floating-point compatible data type. */
+template<typename T>
+class npy_file
+{
+public:
+    /** @param path The path of the file to (over)write.
+     * @param cols The number of elements per row, or 0 for a 1-D array. */
+    npy_file(const char *path, int cols) :
+        cols(cols), rows(0), fd(-1), failed(false), map(0), map_off(0),
+        map_len(0), size(0), pos(0)
+    {
+        page = sysconf(_SC_PAGESIZE);
+        fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+        failed = (fd < 0);
+        char header[NPY_HEADER_SIZE];
+        format_header(header, 0);
+        write_bytes(header, NPY_HEADER_SIZE);
+    }
+
+    ~npy_file()
+    {
+        close();
+    }
+
+    /// Append a row of max(cols, 1) elements.
+    void write_row(const T *row)
+    {
+        write_bytes(row, sizeof(T) * max(cols, 1));
+        ++rows;
+    }
+
+    /** @brief Patch the header, trim the file to its contents and close it.
+     * @return Whether every operation on the file succeeded. */
+    bool close()
+    {
+        if (fd < 0) {
+            return !failed;
+        }
+        unmap();
+        char header[NPY_HEADER_SIZE];
+        format_header(header, rows);
+        failed |= (pwrite(fd, header, NPY_HEADER_SIZE, 0) != NPY_HEADER_SIZE);
+        failed |= (ftruncate(fd, pos) != 0);
+        failed |= (::close(fd) != 0);
+        fd = -1;
+        return !failed;
+    }
+
+    /// Whether every operation on the file so far succeeded.
+    bool ok() const
+    {
+        return !failed;
+    }
+
+private:
+    /// Write the header for 'n' rows, padded with spaces to the full size.
+    void format_header(char *header, long n) const
+    {
+        const int one = 1;
+        const char order = *(const char *)&one ? '<' : '>';
+        char dict[NPY_HEADER_SIZE];
+        if (cols > 0) {
+            snprintf(dict, sizeof(dict), "{'descr': '%c%s', 'fortran_order': "
+                     "False, 'shape': (%ld, %d), }", order,
+                     npy_descr<T>::kind(), n, cols);
+        } else {
+            snprintf(dict, sizeof(dict), "{'descr': '%c%s', 'fortran_order': "
+                     "False, 'shape': (%ld,), }", order,
+                     npy_descr<T>::kind(), n);
+        }
+        memset(header, ' ', NPY_HEADER_SIZE);
+        memcpy(header, "\x93NUMPY\x01\x00", 8); // magic, version 1.0
+        header[8] = NPY_HEADER_SIZE - 10; // header length, little-endian
+        header[9] = 0;
+        memcpy(header + 10, dict, strlen(dict));
+        header[NPY_HEADER_SIZE - 1] = '\n';
+    }
+
+    /// Copy bytes to the file at the current position, moving the window.
+    void write_bytes(const void *data, size_t len)
+    {
+        const char *src = (const char *)data;
+        while (len > 0 && !failed) {
+            if (pos < map_off || pos >= map_off + map_len) {
+                remap();
+                continue;
+            }
+            size_t n = min(len, (size_t)(map_off + map_len - pos));
+            memcpy(map + (pos - map_off), src, n);
+            src += n;
+            pos += n;
+            len -= n;
+        }
+    }
+
+    /// Map the chunk holding the current position, growing the file to fit.
+    /// The growth is allocated on disk up front, so that a full disk fails
+    /// here rather than faulting on a write to the mapping.
+    void remap()
+    {
+        unmap();
+        map_off = pos / page * page;
+        map_len = NPY_CHUNK_SIZE;
+        if (map_off + map_len > size) {
+            if (posix_fallocate(fd, size, map_off + map_len - size) != 0) {
+                failed = true;
+                return;
+            }
+            size = map_off + map_len;
+        }
+        void *m = mmap(0, map_len, PROT_READ | PROT_WRITE, MAP_SHARED, fd,
+                       map_off);
+        if (m == MAP_FAILED) {
+            failed = true;
+            return;
+        }
+        map = (char *)m;
+    }
+
+    /// Release the window; the kernel writes it back in its own time.
+    void unmap()
+    {
+        if (map) {
+            munmap(map, map_len);
+            map = 0;
+            map_len = 0;
+        }
+    }
+
+    const int cols;
+    long rows; // rows written
+    int fd;
+    bool failed; // whether an operation has failed
+    char *map; // the window
+    off_t map_off, map_len; // the range of the file it maps
+    off_t size; // the size of the file
+    off_t pos; // the position to write at
+    off_t page; // the page size, to which map_off is aligned
+    // Owns a file; not to be copied
+    npy_file(const npy_file &);
+    npy_file &operator=(const npy_file &);
+};
+
+/** @brief Output policy of rkab_integrate() which writes the trajectory to
+ * .npy files.
+ * @details Writes the parameter of each accepted step to a 1-D array and the
+ * state to a 2-D array of 'dim' columns, and stops the integration if a write
+ * fails.
+ * @tparam T Floating-point compatible data type. */
+template<typename T>
+class rkab_npy_output
+{
+public:
+    rkab_npy_output(const char *t_path, const char *u_path, int dim) :
+        tfile(t_path, 0), ufile(u_path, dim) {}
+
+    /// Write accepted step n.
+    bool step(int, rkab_step<T> &s)
+    {
+        tfile.write_row(&s.t1);
+        ufile.write_row(s.u1);
+        return tfile.ok() && ufile.ok();
+    }
+
+    /// Nothing to do; step() has written the last step.
+    void finish(int, T, const T *) {}
+
+    /// Close the files; false if any operation on them failed.
+    bool close()
+    {
+        bool t_ok = tfile.close();
+        bool u_ok = ufile.close();
+        return t_ok && u_ok;
+    }
+
+private:
+    npy_file<T> tfile, ufile;
+};
+
+/** @brief Function template for adaptive step size Runge-Kutta methods which
+ * write their output to .npy files.
+ * @details Solves a given system as rkab() does, but writes the parameter and
+ * state of each accepted step to the files at t_path and u_path as it goes,
+ * as arrays of shape (numsteps,) and (numsteps, dim).
+ * @param u_init The initial state array of the system.
+ * @param dim The dimension of the system.
+ * @param maxsteps The maximum number of iterations to run.
+ * @param tol The relative tolerance or a pointer to an array of relative
+ * tolerances for the local error of the system at each step.
+ * @param t The initial value of the system parameter.
+ * @param t_end The target value of the system parameter.
+ * @param get_f A callback function get_f(t, *u_t, *f) which writes the
+ * derivative of u at system parameter t and state u_t to array f.
+ * @param t_path The path of the file to write the parameter to.
+ * @param u_path The path of the file to write the state to.
+ * @param numfailures [out] The number of steps where a failure occured;
+ * may be NULL.
+ * @return The number of accepted steps, or -1 if the files couldn't be
+ * written (errno tells why).
+ * @tparam Tab Tableau type; see rkab_integrate().
+ * @tparam T Floating-point compatible data type.
+ * @tparam Ttol Tolerance type: should be (scalar) T or (array) T*. */
+template<class Tab, typename T, typename tolT>
+int rkab_npy(T *u_init, int dim, int maxsteps, tolT tol, T t, T t_end,
+             void (*get_f)(T, T*, T*), const char *t_path,
+             const char *u_path, int *numfailures)
+{
+    rkab_workspace<T> ws; // RAII; deleted automatically.
+    rkab_npy_output<T> out(t_path, u_path, dim);
+    int failures;
+    int numsteps = rkab_integrate<Tab, T, tolT>(ws, u_init, dim, maxsteps,
+                                                tol, t, t_end, get_f, out,
+                                                failures);
+    if (numfailures) {
+        *numfailures = failures;
+    }
+    return out.close() ? numsteps : -1;
+}
+
+#endif // #include guard
@@ -0,0 +1,135 @@
+/** @file
+ * @brief Templates for adaptive step size Runge-Kutta solvers which stream
+ * their output.
+ * @details Provides a template rkab_observe() which hands the accepted steps
+ * of rkab_integrate() to the caller a chunk at a time, through a buffer the
+ * caller may provide and an optional callback, instead of collecting the
+ * whole trajectory. With decimation the memory used is independent of the
+ * number of steps taken.
+ * @author Jeremiah O'Neil
+ * @copyright GNU Public License. */
+#ifndef INC_RKAB_OBSERVE_hpp // #include guard
+#define INC_RKAB_OBSERVE_hpp // ensure this file is included at most once per unit
+
+#include "rkab.hpp" // rkab_integrate, rkab_workspace, rkab_observer
+
+/** @brief Output policy of rkab_integrate() which streams the trajectory
+ * through a rkab_observer.
+ * @tparam T Floating-point compatible data type. */
+template<typename T>
+class rkab_chunk_output
+{
+public:
+    /// Buffers I allocate hold at least a row; the caller's hold what it
+    /// says, possibly none, in which case nothing is written.
+    rkab_chunk_output(rkab_observer<T> &obs, int dim) :
+        obs(obs), dim(dim),
+        capacity(max(obs.capacity, (!obs.t || !obs.u) ? 1 : 0)), count(0),
+        tbuf(obs.t), ubuf(obs.u), owned(!obs.t || !obs.u)
+    {
+        if (owned) {
+            tbuf = new T[capacity];
+            ubuf = new T[capacity * dim];
+        }
+        obs.numrows = 0;
+    }
+
+    ~rkab_chunk_output()
+    {
+        if (owned) {
+            delete [] tbuf;
+            delete [] ubuf;
+        }
+    }
+
+    /// Write accepted step n if it falls on the stride.
+    bool step(int n, rkab_step<T> &s)
+    {
+        if (obs.stride <= 0 || n % obs.stride != 0) {
+            return true;
+        }
+        return write(s.t1, s.u1);
+    }
+
+    /// Write the last accepted step unless step() already has, and flush.
+    void finish(int n, T t, const T *u)
+    {
+        if (n > 0 && (obs.stride <= 0 || n % obs.stride != 0)
+                  && (obs.observe || count < capacity)) {
+            write(t, u);
+        }
+        flush();
+    }
+
+private:
+    /// Append a row, flushing first if full; false if no more rows fit.
+    bool write(T t, const T *u)
+    {
+        if (capacity == 0) { // no row fits, ever
+            return false;
+        }
+        if (count == capacity) {
+            flush();
+        }
+        tbuf[count] = t;
+        copy(u, u + dim, &ubuf[count * dim]);
+        ++count;
+        ++obs.numrows;
+        return obs.observe || count < capacity;
+    }
+
+    /// Pass the buffered rows to the callback and start over.
+    void flush()
+    {
+        if (obs.observe && count > 0) {
+            obs.observe(count, tbuf, ubuf, obs.data);
+            count = 0;
+        }
+    }
+
+    rkab_observer<T> &obs;
+    const int dim;
+    const int capacity;
+    int count; // rows in the buffers
+    T *tbuf, *ubuf;
+    const bool owned; // whether I allocated the buffers
+};
+
+/** @brief Function template for adaptive step size Runge-Kutta methods which
+ * stream their output.
+ * @details Solves a given system as rkab() does, writing the accepted steps
+ * through a rkab_observer instead of collecting them.
+ * @param u_init The initial state array of the system.
+ * @param dim The dimension of the system.
+ * @param maxsteps The maximum number of iterations to run.
+ * @param tol The relative tolerance or a pointer to an array of relative
+ * tolerances for the local error of the system at each step.
+ * @param t The initial value of the system parameter.
+ * @param t_end The target value of the system parameter.
+ * @param get_f A callback function get_f(t, *u_t, *f) which writes the
+ * derivative of u at system parameter t and state u_t to array f.
+ * @param obs Where to write the output.
+ * @param numfailures [out] The number of steps where a failure occured, or
+ * NULL.
+ * @return The number of accepted steps.
+ * @tparam Tab Tableau type; see rkab_integrate().
+ * @tparam T Floating-point compatible data type.
+ * @tparam Ttol Tolerance type: should be (scalar) T or (array) T*. */
+template<class Tab, typename T, typename tolT>
+int rkab_observe(T *u_init, int dim, int maxsteps, tolT tol, T t, T t_end,
+                 void (*get_f)(T, T*, T*), rkab_observer<T> *obs,
+                 int *numfailures)
+{
+    rkab_workspace<T> ws; // RAII; deleted automatically.
+    rkab_chunk_output<T> out(*obs, dim);
+    int failures;
+    int numsteps = rkab_integrate<Tab, T, tolT>(ws, u_init, dim, maxsteps,
+                                                tol, t, t_end, get_f,
+                                                out, failures);
+    if (numfailures) {
+        *numfailures = failures;
+    }
+    return numsteps;
+}
+
+#endif // #include guard
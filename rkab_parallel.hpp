@@ -0,0 +1,256 @@
+/** @file
+ * @brief Templates for adaptive step size Runge-Kutta solvers of very large
+ * systems, parallel within each step.
+ * @details Provides a template rkab_parallel() which solves a single system
+ * as rkab_observe() does, but splits every pass over the state (the stages,
+ * the measure of the error, and the copies between steps) into blocks run on
+ * a work_stealing_pool kept for the whole solve. Suits systems of a million
+ * elements or more, such as discretized PDEs, where those passes take as
+ * long as the derivative. The derivative may either be evaluated by the
+ * caller as a whole, threaded or not, or be evaluated by the solver in
+ * parallel a block at a time through a callback taking a range of elements.
+ * The blocks depend only on the dimension and the method, and the error is
+ * reduced over them in order, so the solution is the same on any number of
+ * threads; in fact it is that of rkab_observe().
+ * @author Jeremiah O'Neil
+ * @copyright GNU Public License. */
+#ifndef INC_RKAB_PARALLEL_hpp // #include guard
+#define INC_RKAB_PARALLEL_hpp // ensure this file is included at most once per unit
+
+#include "rkab.hpp" // rkab_sum, rkab_workspace, rkab_tol_control
+#include "rkab_observe.hpp" // rkab_chunk_output
+#include "thread_pool.hpp" // work_stealing_pool
+
+/// The bytes a block of one pass of rkab_parallel() streams through, which
+/// should fit in the L2 cache of a core.
+#define RKAB_PARALLEL_BLOCK_BYTES (1 << 18)
+
+/** @brief Class of a partition of a state into blocks, run over a pool.
+ * @details Blocks hold a whole number of cache lines' worth of elements, as
+ * many as fit in RKAB_PARALLEL_BLOCK_BYTES for a pass streaming through
+ * 'arrays' arrays at once. */
+class rkab_blocks
+{
+public:
+    /** @param pool The pool to run on.
+     * @param dim The dimension of the system.
+     * @param arrays The number of arrays of a pass.
+     * @param elem The size of an element in bytes. */
+    rkab_blocks(work_stealing_pool &pool, int dim, int arrays, int elem) :
+        pool(pool), dim(dim),
+        size(max(64, RKAB_PARALLEL_BLOCK_BYTES / (arrays * elem) / 64 * 64)),
+        num((dim + size - 1) / size) {}
+
+    /// Run task(begin, end) over the elements [begin, end) of every block.
+    template<class Task>
+    void run(const Task &task)
+    {
+        pool.run(num, [&](int, int b) {
+            task(b * size, min(dim, (b + 1) * size));
+        });
+    }
+
+    work_stealing_pool &pool; ///< The pool to run on
+    const int dim; ///< The dimension of the system
+    const int size; ///< The number of elements of a block, but the last
+    const int num; ///< The number of blocks
+};
+
+/** @brief Structure template of the derivative callback of rkab_parallel().
+ * @details Calls get_f_range(t, *u_t, *f, begin, end) on every block in
+ * parallel if given, or else get_f(t, *u_t, *f) once.
+ * @tparam T Floating-point compatible data type. */
+template<typename T>
+struct rkab_parallel_f
+{
+    rkab_blocks &blocks; ///< The blocks to evaluate a range callback over
+    void (*get_f)(T, T*, T*); ///< Callback for the whole state
+    void (*get_f_range)(T, T*, T*, int, int); ///< Callback for a block
+
+    void operator()(T t, T *u, T *f) const
+    {
+        if (!get_f_range) {
+            get_f(t, u, f);
+            return;
+        }
+        auto eval = [&]() {
+            blocks.run([&](int begin, int end) {
+                get_f_range(t, u, f, begin, end);
+            });
+        };
+        ODE_STATS(rkab_probe<T>::timed(eval); return;) // as get_f is timed
+        eval();
+    }
+};
+
+/** @brief Template for the stages of one step of an rkab_parallel() method.
+ * @details As rkab_stage, each pass being split over blocks.
+ * @tparam Tab Tableau type; see rkab_integrate().
+ * @tparam T Floating-point compatible data type.
+ * @tparam k The stage whose derivative has just been evaluated. */
+template<class Tab, typename T, int k = 0,
+         bool last = (k == Tab::bstages - 1)>
+struct rkab_parallel_stage
+{
+    static void advance(rkab_blocks &blocks, T t, T h, T *ua, T *ub, T *u_k,
+                        const T *u_prev, T *f, const rkab_parallel_f<T> &deriv)
+    {
+        const int dim = blocks.dim;
+        blocks.run([&](int begin, int end) {
+            for (int i = begin; i < end; ++i){
+                T s = 0;
+                rkab_sum<Tab, T, tableau_a_row<Tab, k>, 0, k>::add(s, f, dim,
+                                                                   i);
+                u_k[i] = u_prev[i] + h * s;
+            }
+        });
+        deriv(t + h * (T)Tab::c[k], u_k, &f[(k + 1) * dim]);
+        rkab_parallel_stage<Tab, T, k + 1>::advance(blocks, t, h, ua, ub, u_k,
+                                                    u_prev, f, deriv);
+    }
+};
+
+/// @cond IMPL
+template<class Tab, typename T, int k>
+struct rkab_parallel_stage<Tab, T, k, true>
+{
+    static void advance(rkab_blocks &blocks, T, T h, T *ua, T *ub, T *,
+                        const T *u_prev, T *f, const rkab_parallel_f<T> &)
+    { // combine the stages into the low- and high-order states
+        const int dim = blocks.dim;
+        blocks.run([&](int begin, int end) {
+            for (int i = begin; i < end; ++i){
+                T sa = 0, sb = 0;
+                rkab_sum<Tab, T, tableau_ba<Tab>, 0, k>::add(sa, f, dim, i);
+                rkab_sum<Tab, T, tableau_bb<Tab>, 0, k>::add(sb, f, dim, i);
+                ua[i] = u_prev[i] + h * sa;
+                ub[i] = u_prev[i] + h * sb;
+            }
+        });
+    }
+};
+/// @endcond
+
+/** @brief Structure template of the stage policy of rkab_parallel().
+ * @details Satisfies the interface described by rkab_integrate_stages(), as
+ * rkab_stages does, with every pass over the state split into blocks, and
+ * the derivative evaluated by rkab_parallel_f.
+ * @tparam Tab Tableau type; see rkab_integrate().
+ * @tparam T Floating-point compatible data type. */
+template<class Tab, typename T>
+struct rkab_parallel_stages
+{
+    rkab_blocks &blocks; ///< The blocks to split each pass into
+    void (*get_f_range)(T, T*, T*, int, int); ///< Callback for a block
+
+    void derivative(T t, T *u, T *f, void (*get_f)(T, T*, T*))
+    {
+        const rkab_parallel_f<T> deriv = {blocks, get_f, get_f_range};
+        deriv(t, u, f);
+    }
+
+    void advance(int, T t, T h, T *ua, T *ub, T *u_k, const T *u_prev,
+                 T *f, void (*get_f)(T, T*, T*))
+    {
+        const rkab_parallel_f<T> deriv = {blocks, get_f, get_f_range};
+        rkab_parallel_stage<Tab, T>::advance(blocks, t, h, ua, ub, u_k,
+                                             u_prev, f, deriv);
+    }
+
+    void copy(int, const T *from, T *to)
+    {
+        blocks.run([&](int begin, int end) {
+            std::copy(from + begin, from + end, to + begin);
+        });
+    }
+};
+
+/** @brief Class template for the step size control of rkab_parallel().
+ * @details That of rkab_tol_control, with the acceptability of a step
+ * measured over each block in parallel, then reduced over the blocks in
+ * order, so that it doesn't depend on the number of threads.
+ * @tparam T Floating-point compatible data type.
+ * @tparam Ttol Tolerance type: should be (scalar) T or (array) T*. */
+template<typename T, typename tolT>
+class rkab_parallel_control : public rkab_tol_control<T, tolT>
+{
+public:
+    rkab_parallel_control(tolT tol, int order, rkab_blocks &blocks,
+                          T *acc_blocks) :
+        rkab_tol_control<T, tolT>(tol, order), blocks(blocks),
+        acc_blocks(acc_blocks) {}
+
+    /// As rkab_tol_control::acceptability(), the least over the blocks.
+    T acceptability(int, const T *, T *ua, T *ub)
+    {
+        blocks.run([&](int begin, int end) {
+            acc_blocks[begin / blocks.size] =
+                this->acceptability_block(begin, end, ua, ub);
+        });
+        T acceptability = numeric_limits<T>::infinity();
+        for (int b = 0; b < blocks.num; ++b) {
+            acceptability = min(acceptability, acc_blocks[b]);
+        }
+        return acceptability;
+    }
+
+private:
+    rkab_blocks &blocks;
+    T *const acc_blocks; // acceptability of each block
+};
+
+/** @brief Function template for adaptive step size Runge-Kutta methods
+ * parallel within each step.
+ * @details Solves a given system over parameterized domain as rkab_observe()
+ * does, with the passes over the state split into blocks run on numthreads
+ * threads, by rkab_integrate_stages() with rkab_parallel_stages and
+ * rkab_parallel_control; see the file description. Exactly one of get_f and
+ * get_f_range should be given.
+ * @param u_init The initial state array of the system.
+ * @param dim The dimension of the system.
+ * @param maxsteps The maximum number of iterations to run.
+ * @param tol The relative tolerance or a pointer to an array of relative
+ * tolerances for the local error of the system at each step.
+ * @param t The initial value of the system parameter.
+ * @param t_end The target value of the system parameter.
+ * @param get_f A callback function get_f(t, *u_t, *f) which writes the
+ * derivative of u at system parameter t and state u_t to array f, or NULL.
+ * @param get_f_range A callback function get_f_range(t, *u_t, *f, begin, end)
+ * which writes elements [begin, end) of the derivative of u at system
+ * parameter t and state u_t (whole) to array f, or NULL. It is called from
+ * several threads at once, on disjoint ranges.
+ * @param numthreads The number of threads, or the number of hardware
+ * threads if not positive.
+ * @param obs Where to write the output.
+ * @param numfailures [out] The number of steps where a failure occured, or
+ * NULL.
+ * @return The number of accepted steps.
+ * @tparam Tab Tableau type; see rkab_integrate().
+ * @tparam T Floating-point compatible data type.
+ * @tparam Ttol Tolerance type: should be (scalar) T or (array) T*. */
+template<class Tab, typename T, typename tolT>
+int rkab_parallel(T *u_init, int dim, int maxsteps, tolT tol, T t, T t_end,
+                  void (*get_f)(T, T*, T*),
+                  void (*get_f_range)(T, T*, T*, int, int), int numthreads,
+                  rkab_observer<T> *obs, int *numfailures)
+{
+    work_stealing_pool pool(numthreads); // persists for the whole solve
+    // The last pass streams through every stage and three states
+    rkab_blocks blocks(pool, dim, Tab::bstages + 3, sizeof(T));
+    rkab_parallel_stages<Tab, T> stages = {blocks, get_f_range};
+    vector<T> acc_blocks(blocks.num);
+    rkab_parallel_control<T, tolT> ctl(tol, Tab::order, blocks,
+                                       acc_blocks.data());
+    rkab_workspace<T> ws; // RAII; deleted automatically.
+    rkab_chunk_output<T> out(*obs, dim);
+    int failures;
+    int numsteps = rkab_integrate_stages<Tab, T>(ws, stages, u_init, dim,
+                                                 maxsteps, ctl, t, t_end,
+                                                 get_f, out, failures);
+    if (numfailures) {
+        *numfailures = failures;
+    }
+    return numsteps;
+}
+
+#endif // #include guard
@@ -0,0 +1,146 @@
+/** @file
+ * @brief Templates for solving one long trajectory in parallel in time.
+ * @details Provides a template rkab_parareal() which splits the domain of a
+ * single initial value problem into slices and solves them at once on a
+ * work_stealing_pool by the parareal method (Lions, Maday and Turinici): a
+ * cheap coarse propagator guesses the state at the start of every slice, the
+ * slices are solved from the guesses with rkab() in parallel, and the
+ * guesses are corrected with the coarse propagator, sequentially, until they
+ * settle. With K iterations the method does about K times the work of
+ * rkab() on numslices threads, so it pays off where K is much less than
+ * numslices: problems which the coarse propagator follows well, unlike
+ * chaotic ones.
+ * @author Jeremiah O'Neil
+ * @copyright GNU Public License. */
+#ifndef INC_RKAB_PARAREAL_hpp // #include guard
+#define INC_RKAB_PARAREAL_hpp // ensure this file is included at most once per unit
+
+#include "rkab.hpp" // rkab, rkab_workspace, rkab_parareal_options
+#include "rkfixed.hpp" // rkfixed
+#include "thread_pool.hpp" // work_stealing_pool
+
+/** @brief Function template for adaptive step size Runge-Kutta methods,
+ * parallel in time.
+ * @details Solves a given system over parameterized domain as rkab() does,
+ * but in opts->numslices slices of equal length solved in parallel by the
+ * parareal iteration. The coarse propagator takes opts->coarsesteps fixed
+ * steps per slice with the high-order weights of the same tableau (see
+ * rkfixed()); the fine propagator is rkab() itself. Iteration k solves the
+ * slices from the k-th on, whose starting states are not yet exact, and
+ * then corrects the states at the slice boundaries by U_(n+1) = G(U_n) +
+ * F(U_n') - G(U_n'), where F and G are the fine and coarse propagators and
+ * the primes mark the states of the last iteration. The trajectory returned
+ * is that of the last fine solves, concatenated, so it is continuous at the
+ * slice boundaries to within opts->tol.
+ * @param u_init The initial state array of the system.
+ * @param dim The dimension of the system.
+ * @param maxsteps The maximum number of iterations to run per slice.
+ * @param tol The relative tolerance or a pointer to an array of relative
+ * tolerances for the local error of the system at each step.
+ * @param t The initial value of the system parameter.
+ * @param t_end The target value of the system parameter.
+ * @param get_f A callback function get_f(t, *u_t, *f) which writes the
+ * derivative of u at system parameter t and state u_t to array f. It is called
+ * from several threads at once.
+ * @param opts The slices, coarse propagator, convergence tolerance and
+ * threads; receives the number of iterations taken.
+ * @tparam Tab Tableau type; see rkab_integrate().
+ * @tparam T Floating-point compatible data type.
+ * @tparam Ttol Tolerance type: should be (scalar) T or (array) T*. */
+template<class Tab, typename T, typename tolT>
+struct results_rkab<T> *rkab_parareal(T *u_init, int dim, int maxsteps,
+                                      tolT tol, T t, T t_end,
+                                      void (*get_f)(T, T*, T*),
+                                      rkab_parareal_options<T> *opts)
+{
+    const int N = max(opts->numslices, 1);
+    const int nc = max(opts->coarsesteps, 1);
+    const int maxiter = (opts->maxiter > 0) ? min(opts->maxiter, N) : N;
+    int numthreads = opts->numthreads;
+    if (numthreads <= 0) {
+        numthreads = thread::hardware_concurrency();
+    }
+    vector<T> ts(N + 1); // slice boundaries
+    for (int n = 0; n < N; ++n) {
+        ts[n] = t + (t_end - t) * n / N;
+    }
+    ts[N] = t_end;
+    vector<T> U((N + 1) * (size_t)dim); // states at the boundaries
+    vector<T> G(N * (size_t)dim); // coarse ends of the slices, from U
+    vector<T> F(N * (size_t)dim); // fine ends of the slices, from U
+    vector<T> g(dim); // a coarse end, from the corrected U
+    // The larger change, or NaN if either is (a coarse step blew up)
+    auto worst = [](T a, T b) { return (b <= a) ? a : b; };
+    // The coarse propagator over slice n, from u into end
+    auto coarse = [&](int n, T *u, T *end) {
+        rkfixed<Tab, T>(end, u, dim, nc, (ts[n + 1] - ts[n]) / nc, ts[n],
+                        get_f, 0);
+    };
+    copy(u_init, u_init + dim, U.begin());
+    for (int n = 0; n < N; ++n) { // the first guess is coarse throughout
+        coarse(n, &U[n * dim], &G[n * dim]);
+        copy(&G[n * dim], &G[n * dim] + dim, &U[(n + 1) * dim]);
+    }
+
+    vector<results_rkab<T> *> slices(N, (results_rkab<T> *)0);
+    work_stealing_pool pool(max(1, min(numthreads, N)));
+    vector<rkab_workspace<T> > ws(pool.size()); // one per worker
+    int k = 0;
+    while (true) {
+        // Solve the slices from k on, whose starting states have changed
+        pool.run(N - k, [&](int w, int i) {
+            const int n = k + i;
+            if (slices[n]) {
+                delete_results_rkab(slices[n]);
+            }
+            slices[n] = rkab<Tab, T, tolT>(ws[w], &U[n * dim], dim,
+                                           maxsteps, tol, ts[n], ts[n + 1],
+                                           get_f);
+            const int last = slices[n]->numsteps - 1;
+            const T *end = (last >= 0) ? &slices[n]->u[last * dim]
+                                       : &U[n * dim];
+            copy(end, end + dim, &F[n * dim]);
+        });
+        ++k; // slices before k now start from exact states
+        if (k >= maxiter) {
+            break;
+        }
+        // Correct the boundaries; U_k is exact, being the fine end of k-1
+        T change = 0;
+        for (int i = 0; i < dim; ++i) {
+            const T u = F[(k - 1) * dim + i];
+            T &u_old = U[k * dim + i];
+            change = worst(change, abs(u - u_old) / max(abs(u), (T)1));
+            u_old = u;
+        }
+        for (int n = k; n < N; ++n) {
+            coarse(n, &U[n * dim], g.data());
+            for (int i = 0; i < dim; ++i) {
+                const T u = g[i] + F[n * dim + i] - G[n * dim + i];
+                T &u_old = U[(n + 1) * dim + i];
+                change = worst(change, abs(u - u_old) / max(abs(u), (T)1));
+                u_old = u;
+            }
+            copy(g.begin(), g.end(), &G[n * dim]);
+        }
+        if (change <= opts->tol) {
+            break;
+        }
+    }
+    opts->numiter = k;
+
+    // Concatenate the slices
+    vector<T> tvec, u;
+    int numsteps = 0, numfailures = 0;
+    for (int n = 0; n < N; ++n) {
+        const results_rkab<T> *r = slices[n];
+        tvec.insert(tvec.end(), r->t, r->t + r->numsteps);
+        u.insert(u.end(), r->u, r->u + (size_t)r->numsteps * dim);
+        numsteps += r->numsteps;
+        numfailures += r->numfailures;
+        delete_results_rkab(slices[n]);
+    }
+    return new_results_rkab(numsteps, numfailures, tvec, u);
+}
+
+#endif // #include guard
@@ -0,0 +1,181 @@
+/** @file
+ * @brief Opt-in instrumentation of the adaptive step size solvers.
+ * @details Defines rkab_stats, the statistics a solve records when the
+ * library is compiled with ODE_INSTRUMENT defined, and the probe that
+ * records them. Without ODE_INSTRUMENT the hooks expand to nothing, so the
+ * solvers are compiled exactly as if they weren't there, and the 'stats' of
+ * every results_rkab is NULL.
+ * @author Jeremiah O'Neil
+ * @copyright GNU Public License. */
+#ifndef INC_RKAB_STATS_hpp // #include guard
+#define INC_RKAB_STATS_hpp // ensure this file is included at most once per unit
+
+#include <algorithm> // for min, max
+#include <chrono> // for steady_clock
+#include <cmath> // for frexp
+using namespace std;
+
+/// The number of bins of the step size histogram of rkab_stats
+#define RKAB_STATS_BINS 64
+/// The bin of rkab_stats::hhist counting steps of 1 <= |h| < 2
+#define RKAB_STATS_BIN_ONE 48
+
+/** @brief Structure describing where the time and steps of a solve went.
+ * @details Recorded by the solvers only if the library is compiled with
+ * ODE_INSTRUMENT defined. It doesn't depend on the data type, so the C
+ * interface shares one definition among all types. */
+struct rkab_stats
+{
+    /// The number of derivative evaluations
+    long numevals;
+    /// The number of rejected attempts at a step
+    long numrejections;
+    /// The number of rejections after the first of a step, where the error
+    /// was underestimated and the step size halved
+    long numpessimistic;
+    /// The longest run of such rejections in one step
+    long maxpessimistic;
+    /// The number of steps accepted only because the step size was minimal
+    long numhmin;
+    /// Accepted steps by step size: bin b counts steps of 2^(b - 48) <= |h|
+    /// < 2^(b - 47), and the first and last bins everything beyond
+    long hhist[RKAB_STATS_BINS];
+    /// Wall time in seconds spent inside the derivative callback
+    double seconds_f;
+    /// Wall time in seconds spent writing output (less any derivatives
+    /// evaluated there, eg., for interpolation)
+    double seconds_output;
+    /// Wall time in seconds spent in the solver otherwise
+    double seconds_kernel;
+};
+
+#ifdef ODE_INSTRUMENT
+/// Compile the statement(s) only if instrumented.
+#define ODE_STATS(...) __VA_ARGS__
+/// The statistics of a workspace, or NULL if not instrumented.
+#define ODE_STATS_OF(ws) (&(ws).stats)
+#else
+#define ODE_STATS(...)
+#define ODE_STATS_OF(ws) ((rkab_stats *)0)
+#endif
+
+/** @brief Function for copying statistics to the heap for a results_rkab.
+ * @return A copy of *stats, or NULL if stats is. */
+inline rkab_stats *new_rkab_stats(const rkab_stats *stats)
+{
+    return stats ? new rkab_stats(*stats) : 0;
+}
+
+/** @brief Function template for counting an accepted step in the step size
+ * histogram. */
+template<typename T>
+void rkab_stats_step(rkab_stats &stats, T h)
+{
+    int e;
+    frexp(h, &e); // |h| = m * 2^e, 1/2 <= m < 1
+    const int b = e - 1 + RKAB_STATS_BIN_ONE;
+    ++stats.hhist[min(max(b, 0), RKAB_STATS_BINS - 1)];
+}
+
+/** @brief Class template recording the statistics of a solve.
+ * @details Zeroes the statistics on construction and accounts the wall time
+ * on destruction. Counts and times the derivative callback by standing in
+ * for it: get_f() gives a function which calls the callback it was
+ * constructed with. Since the solvers take the callback as a plain function
+ * pointer, the callback and statistics are kept per thread, and restored on
+ * destruction, so that solves can run on several threads, or nest within a
+ * callback, at once.
+ * @tparam T Floating-point compatible data type. */
+template<typename T>
+class rkab_probe
+{
+public:
+    rkab_probe(rkab_stats &stats, void (*get_f)(T, T*, T*)) :
+        stats(stats), outer_stats(current), outer_f(inner),
+        start(now()), output_start(0), output_f(0)
+    {
+        stats = rkab_stats();
+        current = &stats;
+        inner = get_f;
+    }
+
+    ~rkab_probe()
+    {
+        stats.seconds_kernel = now() - start - stats.seconds_f
+                             - stats.seconds_output;
+        current = outer_stats;
+        inner = outer_f;
+    }
+
+    /// The instrumented stand-in for the derivative callback.
+    void (*get_f() const)(T, T*, T*)
+    {
+        return timed_f;
+    }
+
+    /** @brief Time and count an evaluation of the derivative made by call()
+     * rather than through get_f(), eg., a block at a time on several
+     * threads, for the solve being recorded on this thread. */
+    template<class Call>
+    static void timed(const Call &call)
+    {
+        rkab_stats *s = current;
+        const double t0 = now();
+        call();
+        s->seconds_f += now() - t0;
+        ++s->numevals;
+    }
+
+    /// Mark the start of output.
+    void output_begin()
+    {
+        output_start = now();
+        output_f = stats.seconds_f;
+    }
+
+    /// Mark the end of output.
+    void output_end()
+    {
+        stats.seconds_output += now() - output_start
+                              - (stats.seconds_f - output_f);
+    }
+
+private:
+    static double now()
+    {
+        return chrono::duration<double>(
+            chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    static void timed_f(T t, T *u, T *f)
+    {
+        // Copy first; the callback may itself run an instrumented solve
+        rkab_stats *s = current;
+        void (*get_f)(T, T*, T*) = inner;
+        const double t0 = now();
+        get_f(t, u, f);
+        s->seconds_f += now() - t0;
+        ++s->numevals;
+    }
+
+    static thread_local rkab_stats *current;
+    static thread_local void (*inner)(T, T*, T*);
+
+    rkab_stats &stats;
+    rkab_stats *const outer_stats;
+    void (*const outer_f)(T, T*, T*);
+    const double start;
+    double output_start, output_f;
+    // Redirects thread state; not to be copied
+    rkab_probe(const rkab_probe &);
+    rkab_probe &operator=(const rkab_probe &);
+};
+
+/// @cond IMPL
+template<typename T>
+thread_local rkab_stats *rkab_probe<T>::current = 0;
+template<typename T>
+thread_local void (*rkab_probe<T>::inner)(T, T*, T*) = 0;
+/// @endcond
+
+#endif // #include guard
@@ -0,0 +1,84 @@
+/** @file
+ * @brief Bogacki-Shampine 3(2) method: adaptive step Runge-Kutta
+ * implementation
+ * @details Provides a C interface; see adaptive_step_rk.h for details. Unlike
+ * rk23.cpp, which shares its tableau, this propagates the third order
+ * solution, at which the last stage is evaluated; the method is then FSAL
+ * (first same as last), so an accepted step costs three derivative
+ * evaluations rather than four.
+ * @author Jeremiah O'Neil
+ * @copyright GNU Public License. */
+#include "rkab.hpp" // templates
+#include "rkab_batch.hpp" // batched templates
+#include "rkab_ensemble.hpp" // multithreaded templates
+#include "rkab_observe.hpp" // streaming templates
+#include "rkab_dense.hpp" // dense output templates
+#include "rkab_control.hpp" // step size control templates
+#include "rkab_npy.hpp" // on-disk output templates
+#include "rkab_events.hpp" // event detection templates
+#include "rkab_parareal.hpp" // parallel-in-time templates
+#include "rkab_mixed.hpp" // mixed-precision templates
+#include "rkab_parallel.hpp" // parallel-within-step templates
+#include "rkab_multirate.hpp" // multirate templates
+#include "rkab_async.hpp" // background solve templates
+#include "adaptive_step_rk.h" // interface
+
+/// Runge-Kutta matrix nonzero part, transposed and flattened.
+#define A \
+    {1/2.L,     0, 2/9.L,\
+            3/4.L, 1/3.L,\
+                   4/9.L}
+/// Weights, with leading zero removed.
+#define C \
+    {1/2.L, 3/4.L, 1}
+/// Nodes of low-order method.
+#define BA \
+    {7/24.L, 1/4.L, 1/3.L, 1/8.L}
+/// Nodes of high-order method.
+#define BB \
+    {2/9.L, 1/3.L, 4/9.L, 0}
+
+/// Modified Butcher tableau, as a type to bind to rkab() at compile time.
+struct tableau_rkbs32
+{
+    static constexpr int order = 3, astages = 4, bstages = 4;
+    static constexpr bool fsal = true;
+    static constexpr long double a[] = A, c[] = C, ba[] = BA, bb[] = BB;
+};
+constexpr long double tableau_rkbs32::a[], tableau_rkbs32::c[], tableau_rkbs32::ba[], tableau_rkbs32::bb[];
+
+/** Instantiate as defined in adaptive_step_rk.h, binding the modified Butcher
+ * tableau to an rkab function instance.
+ * Should be used through MAP_TARGETS_TO(). */
+#define INST_RKBS32(T, Tid)                                               \
+    INST_RKAB(bs32##Tid, T, T, tableau_rkbs32)                            \
+    INST_RKAB(bs32_arrtol##Tid, T, T *, tableau_rkbs32)                   \
+    INST_RKAB_OPT(bs32_opt##Tid, T, tableau_rkbs32)                       \
+    INST_RKAB_SOLVE(bs32_solve##Tid, T, T, tableau_rkbs32)                \
+    INST_RKAB_SOLVE(bs32_solve_arrtol##Tid, T, T *, tableau_rkbs32)       \
+    INST_RKAB_BATCH(bs32_batch##Tid, T, T, tableau_rkbs32)                \
+    INST_RKAB_BATCH(bs32_batch_arrtol##Tid, T, T *, tableau_rkbs32)       \
+    INST_RKAB_ENSEMBLE(bs32_ensemble##Tid, T, T, tableau_rkbs32)          \
+    INST_RKAB_ENSEMBLE(bs32_ensemble_arrtol##Tid, T, T *, tableau_rkbs32) \
+    INST_RKAB_OBSERVE(bs32_observe##Tid, T, T, tableau_rkbs32)            \
+    INST_RKAB_OBSERVE(bs32_observe_arrtol##Tid, T, T *, tableau_rkbs32)   \
+    INST_RKAB_NPY(bs32_npy##Tid, T, T, tableau_rkbs32)                    \
+    INST_RKAB_NPY(bs32_npy_arrtol##Tid, T, T *, tableau_rkbs32)           \
+    INST_RKAB_EVENTS(bs32_events##Tid, T, T, tableau_rkbs32)              \
+    INST_RKAB_EVENTS(bs32_events_arrtol##Tid, T, T *, tableau_rkbs32)     \
+    INST_RKAB_PARAREAL(bs32_parareal##Tid, T, T, tableau_rkbs32)          \
+    INST_RKAB_PARAREAL(bs32_parareal_arrtol##Tid, T, T *, tableau_rkbs32) \
+    INST_RKAB_TEVAL(bs32_teval##Tid, T, T, tableau_rkbs32)                \
+    INST_RKAB_TEVAL(bs32_teval_arrtol##Tid, T, T *, tableau_rkbs32)       \
+    INST_RKAB_PARALLEL(bs32_parallel##Tid, T, T, tableau_rkbs32)          \
+    INST_RKAB_PARALLEL(bs32_parallel_arrtol##Tid, T, T *, tableau_rkbs32) \
+    INST_RKAB_MULTIRATE(bs32_multirate##Tid, T, T, tableau_rkbs32)        \
+    INST_RKAB_MULTIRATE(bs32_multirate_arrtol##Tid, T, T *, tableau_rkbs32) \
+    INST_RKAB_ASYNC(bs32_async##Tid, T, T, tableau_rkbs32)                \
+    INST_RKAB_ASYNC(bs32_async_arrtol##Tid, T, T *, tableau_rkbs32)
+
+MAP_TARGETS_TO(INST_RKBS32)
+
+// Mixed precision, for the one pair of types
+INST_RKAB_MIXED(bs32_fd, double, float, double, tableau_rkbs32)
+INST_RKAB_MIXED(bs32_arrtol_fd, double, float, double *, tableau_rkbs32)
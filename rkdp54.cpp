@@ -0,0 +1,85 @@
+/** @file
+ * @brief Dormand-Prince method: adaptive step Runge-Kutta implementation
+ * @details Provides a C interface; see adaptive_step_rk.h for details. The
+ * method is FSAL (first same as last), so an accepted step costs six
+ * derivative evaluations rather than seven.
+ * @author Jeremiah O'Neil
+ * @copyright GNU Public License. */
+#include "rkab.hpp" // templates
+#include "rkab_batch.hpp" // batched templates
+#include "rkab_ensemble.hpp" // multithreaded templates
+#include "rkab_observe.hpp" // streaming templates
+#include "rkab_dense.hpp" // dense output templates
+#include "rkab_control.hpp" // step size control templates
+#include "rkab_npy.hpp" // on-disk output templates
+#include "rkab_events.hpp" // event detection templates
+#include "rkab_parareal.hpp" // parallel-in-time templates
+#include "rkab_mixed.hpp" // mixed-precision templates
+#include "rkab_parallel.hpp" // parallel-within-step templates
+#include "rkab_multirate.hpp" // multirate templates
+#include "rkab_async.hpp" // background solve templates
+#include "adaptive_step_rk.h" // interface
+
+/// Runge-Kutta matrix nonzero part, transposed and flattened.
+#define A \
+    {1/5.L, 3/40.L,  44/45.L,  19372/6561.L,   9017/3168.L,      35/384.L, \
+            9/40.L, -56/15.L, -25360/2187.L,     -355/33.L,             0, \
+                      32/9.L,  64448/6561.L, 46732/5247.L,    500/1113.L, \
+                                 -212/729.L,     49/176.L,     125/192.L, \
+                                             -5103/18656.L, -2187/6784.L, \
+                                                                11/84.L}
+/// Weights, with leading zero removed.
+#define C \
+    {1/5.L, 3/10.L, 4/5.L, 8/9.L, 1, 1}
+/// Nodes of low-order method.
+#define BA \
+    {5179/57600.L, 0, 7571/16695.L, 393/640.L, -92097/339200.L, 187/2100.L, \
+     1/40.L}
+/// Nodes of high-order method.
+#define BB \
+    {35/384.L, 0, 500/1113.L, 125/192.L, -2187/6784.L, 11/84.L, 0}
+
+/// Modified Butcher tableau, as a type to bind to rkab() at compile time.
+struct tableau_rkdp54
+{
+    static constexpr int order = 5, astages = 7, bstages = 7;
+    static constexpr bool fsal = true;
+    static constexpr long double a[] = A, c[] = C, ba[] = BA, bb[] = BB;
+};
+constexpr long double tableau_rkdp54::a[], tableau_rkdp54::c[], tableau_rkdp54::ba[], tableau_rkdp54::bb[];
+
+/** Instantiate as defined in adaptive_step_rk.h, binding the modified Butcher
+ * tableau to an rkab function instance.
+ * Should be used through MAP_TARGETS_TO(). */
+#define INST_RKDP54(T, Tid)                                               \
+    INST_RKAB(dp54##Tid, T, T, tableau_rkdp54)                            \
+    INST_RKAB(dp54_arrtol##Tid, T, T *, tableau_rkdp54)                   \
+    INST_RKAB_OPT(dp54_opt##Tid, T, tableau_rkdp54)                       \
+    INST_RKAB_SOLVE(dp54_solve##Tid, T, T, tableau_rkdp54)                \
+    INST_RKAB_SOLVE(dp54_solve_arrtol##Tid, T, T *, tableau_rkdp54)       \
+    INST_RKAB_BATCH(dp54_batch##Tid, T, T, tableau_rkdp54)                \
+    INST_RKAB_BATCH(dp54_batch_arrtol##Tid, T, T *, tableau_rkdp54)       \
+    INST_RKAB_ENSEMBLE(dp54_ensemble##Tid, T, T, tableau_rkdp54)          \
+    INST_RKAB_ENSEMBLE(dp54_ensemble_arrtol##Tid, T, T *, tableau_rkdp54) \
+    INST_RKAB_OBSERVE(dp54_observe##Tid, T, T, tableau_rkdp54)            \
+    INST_RKAB_OBSERVE(dp54_observe_arrtol##Tid, T, T *, tableau_rkdp54)   \
+    INST_RKAB_NPY(dp54_npy##Tid, T, T, tableau_rkdp54)                    \
+    INST_RKAB_NPY(dp54_npy_arrtol##Tid, T, T *, tableau_rkdp54)           \
+    INST_RKAB_EVENTS(dp54_events##Tid, T, T, tableau_rkdp54)              \
+    INST_RKAB_EVENTS(dp54_events_arrtol##Tid, T, T *, tableau_rkdp54)     \
+    INST_RKAB_PARAREAL(dp54_parareal##Tid, T, T, tableau_rkdp54)          \
+    INST_RKAB_PARAREAL(dp54_parareal_arrtol##Tid, T, T *, tableau_rkdp54) \
+    INST_RKAB_TEVAL(dp54_teval##Tid, T, T, tableau_rkdp54)                \
+    INST_RKAB_TEVAL(dp54_teval_arrtol##Tid, T, T *, tableau_rkdp54)       \
+    INST_RKAB_PARALLEL(dp54_parallel##Tid, T, T, tableau_rkdp54)          \
+    INST_RKAB_PARALLEL(dp54_parallel_arrtol##Tid, T, T *, tableau_rkdp54) \
+    INST_RKAB_MULTIRATE(dp54_multirate##Tid, T, T, tableau_rkdp54)        \
+    INST_RKAB_MULTIRATE(dp54_multirate_arrtol##Tid, T, T *, tableau_rkdp54) \
+    INST_RKAB_ASYNC(dp54_async##Tid, T, T, tableau_rkdp54)                \
+    INST_RKAB_ASYNC(dp54_async_arrtol##Tid, T, T *, tableau_rkdp54)
+
+MAP_TARGETS_TO(INST_RKDP54)
+
+// Mixed precision, for the one pair of types
+INST_RKAB_MIXED(dp54_fd, double, float, double, tableau_rkdp54)
+INST_RKAB_MIXED(dp54_arrtol_fd, double, float, double *, tableau_rkdp54)
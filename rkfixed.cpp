@@ -0,0 +1,66 @@
+/** @file
+ * @brief Fixed step size Runge-Kutta methods: Euler, Heun, classical RK4 and
+ * the 3/8 rule
+ * @details Provides a C interface; see euler.h for details.
+ * @author Jeremiah O'Neil
+ * @copyright GNU Public License. */
+#include "rkfixed.hpp" // templates
+#include "euler.h" // interface
+
+/// Butcher tableau of the Euler method, as a type to bind to rkfixed().
+struct tableau_euler
+{
+    static constexpr int order = 1, bstages = 1;
+    static constexpr long double a[] = {0}, c[] = {0}, bb[] = {1};
+};
+constexpr long double tableau_euler::a[], tableau_euler::c[], tableau_euler::bb[];
+
+/// euler() has always advanced the parameter by summing h.
+template<>
+struct rkfixed_accumulate<tableau_euler>
+{
+    static constexpr bool value = true;
+};
+
+/// Butcher tableau of Heun's method (explicit trapezoid rule).
+struct tableau_heun
+{
+    static constexpr int order = 2, bstages = 2;
+    static constexpr long double a[] = {1}, c[] = {1}, bb[] = {1/2.L, 1/2.L};
+};
+constexpr long double tableau_heun::a[], tableau_heun::c[], tableau_heun::bb[];
+
+/// Butcher tableau of the classical Runge-Kutta method.
+struct tableau_rk4
+{
+    static constexpr int order = 4, bstages = 4;
+    static constexpr long double a[] = {1/2.L,     0, 0,
+                                               1/2.L, 0,
+                                                      1},
+                                 c[] = {1/2.L, 1/2.L, 1},
+                                 bb[] = {1/6.L, 1/3.L, 1/3.L, 1/6.L};
+};
+constexpr long double tableau_rk4::a[], tableau_rk4::c[], tableau_rk4::bb[];
+
+/// Butcher tableau of the 3/8-rule Runge-Kutta method.
+struct tableau_rk38
+{
+    static constexpr int order = 4, bstages = 4;
+    static constexpr long double a[] = {1/3.L, -1/3.L,  1,
+                                                    1, -1,
+                                                        1},
+                                 c[] = {1/3.L, 2/3.L, 1},
+                                 bb[] = {1/8.L, 3/8.L, 3/8.L, 1/8.L};
+};
+constexpr long double tableau_rk38::a[], tableau_rk38::c[], tableau_rk38::bb[];
+
+/** Instantiate as defined in euler.h, binding each tableau to an rkfixed
+ * function instance.
+ * Should be used through MAP_TARGETS_TO(). */
+#define INST_FIXED(T, Tid)                          \
+    INST_RKFIXED(euler, T, Tid, tableau_euler)      \
+    INST_RKFIXED(heun, T, Tid, tableau_heun)        \
+    INST_RKFIXED(rk4, T, Tid, tableau_rk4)          \
+    INST_RKFIXED(rk38, T, Tid, tableau_rk38)
+
+MAP_TARGETS_TO(INST_FIXED)
@@ -0,0 +1,119 @@
+/** @file
+ * @brief Templates for fixed step size explicit Runge-Kutta solvers
+ * @details Provides a template rkfixed() which advances a system a given
+ * number of steps of a given size with the method of a Butcher tableau, in
+ * the format of those of rkab() but with a single set of weights 'bb' and no
+ * error estimate. The stages are unrolled at compile time as in rkab(), so
+ * the cost of a step is fixed: its derivative evaluations and a pass over
+ * the state per stage. The solution is written to memory held by the caller.
+ * @author Jeremiah O'Neil
+ * @copyright GNU Public License. */
+#ifndef INC_RKFIXED_hpp // #include guard
+#define INC_RKFIXED_hpp // ensure this file is included at most once per unit
+
+#include "rkab.hpp" // rkab_sum, tableau_a_row, tableau_bb
+
+/** @brief Template for the stages of one step of an rkfixed() method.
+ * @details As rkab_stage, but the last pass forms the one new state.
+ * @tparam Tab Tableau type; see rkfixed().
+ * @tparam T Floating-point compatible data type.
+ * @tparam k The stage whose derivative has just been evaluated. */
+template<class Tab, typename T, int k = 0,
+         bool last = (k == Tab::bstages - 1)>
+struct rkfixed_stage
+{
+    static void advance(int dim, T t, T h, T *u_next, T *u_k,
+                        const T *u_prev, T *f, void (*get_f)(T, T*, T*))
+    {
+        for (int i = 0; i < dim; ++i){
+            T s = 0;
+            rkab_sum<Tab, T, tableau_a_row<Tab, k>, 0, k>::add(s, f, dim, i);
+            u_k[i] = u_prev[i] + h * s;
+        }
+        get_f(t + h * (T)Tab::c[k], u_k, &f[(k + 1) * dim]);
+        rkfixed_stage<Tab, T, k + 1>::advance(dim, t, h, u_next, u_k, u_prev,
+                                              f, get_f);
+    }
+};
+
+/// @cond IMPL
+template<class Tab, typename T, int k>
+struct rkfixed_stage<Tab, T, k, true>
+{
+    static void advance(int dim, T, T h, T *u_next, T *, const T *u_prev,
+                        T *f, void (*)(T, T*, T*))
+    { // combine the stages into the new state
+        for (int i = 0; i < dim; ++i){
+            T s = 0;
+            rkab_sum<Tab, T, tableau_bb<Tab>, 0, k>::add(s, f, dim, i);
+            u_next[i] = u_prev[i] + h * s;
+        }
+    }
+};
+/// @endcond
+
+/** @brief Structure template of whether rkfixed() advances the parameter
+ * of a method by summing h each step, rather than as t + n * h.
+ * @details The latter doesn't drift over many steps; specialize this to keep
+ * the former for a method whose results have always depended on it.
+ * @tparam Tab Tableau type; see rkfixed(). */
+template<class Tab>
+struct rkfixed_accumulate
+{
+    static constexpr bool value = false;
+};
+
+/** @brief Function template for fixed step size Runge-Kutta methods.
+ * @details Advances a given system numsteps steps of size h, writing the
+ * state after every stride-th step and after the last, so that writing can be
+ * skipped where it would cost more than the step (eg., at small dim). The
+ * states in between are kept in scratch memory allocated once per call.
+ * @param u [out] The memory to write the solution to: room for
+ * ceil(numsteps / stride) states of dim (1 if stride isn't positive).
+ * @param u_init The initial state array of the system.
+ * @param dim The dimension of the system.
+ * @param numsteps The number of iterations to run.
+ * @param h The system parameter iteration step size.
+ * @param t The initial value of the system parameter.
+ * @param get_f A callback function get_f(t, *u_t, *f) which writes the
+ * derivative of u at system parameter t and state u_t to array f.
+ * @param stride Write every stride-th state and the last; if not positive,
+ * write only the last.
+ * @return The number of states written.
+ * @tparam Tab Tableau type: a structure with members 'static constexpr' int
+ * order, bstages (the number of stages) and long double a[] (the nonzero part
+ * of the Runge-Kutta matrix, transposed and flattened, or {0} for one stage),
+ * c[] (the nodes, with leading zero removed, or {0} for one stage) and bb[]
+ * (the weights).
+ * @tparam T Floating-point compatible data type. */
+template<class Tab, typename T>
+int rkfixed(T *u, T *u_init, int dim, int numsteps, T h, T t,
+            void (*get_f)(T, T*, T*), int stride = 1)
+{
+    // Stage derivatives, then the stage state and two states in between
+    vector<T> block((Tab::bstages + 3) * (size_t)dim);
+    T *f = block.data();
+    T *u_k = f + Tab::bstages * dim;
+    T *scratch[] = {u_k + dim, u_k + 2 * dim};
+    const T t0 = t;
+    T *u_prev = u_init;
+    int numrows = 0;
+    for (int n = 1, due = stride; n <= numsteps; ++n)
+    {
+        const bool write = (--due == 0) || n == numsteps;
+        T *u_next = write ? &u[(size_t)numrows * dim]
+                          : scratch[u_prev == scratch[0]];
+        get_f(t, u_prev, f);
+        rkfixed_stage<Tab, T>::advance(dim, t, h, u_next, u_k, u_prev, f,
+                                       get_f);
+        t = rkfixed_accumulate<Tab>::value ? t + h : t0 + n * h;
+        if (write) {
+            ++numrows;
+            due = stride;
+        }
+        u_prev = u_next;
+    }
+    return numrows;
+}
+
+#endif // #include guard
@@ -0,0 +1,197 @@
+/** @file
+ * @brief Templates for low-storage adaptive step size Runge-Kutta solvers.
+ * @details Provides a template rkls() for methods in Williamson's 2N form,
+ * whose stages need only two state registers however many there are: the
+ * state being advanced, u, and an increment, du, updated at stage k by
+ *     du = A_k du + h f(t + C_k h, u),   u = u + B_k du.
+ * An embedded estimate of the error accumulates alongside, in a third
+ * register, as e = h sum_k E_k f_k. With the derivative written by the
+ * callback and the state at the start of the step, which a rejected step
+ * starts over from, a solve holds five arrays of the dimension of the system
+ * where rkab() holds the stages plus five: half as many for rk45. Each stage
+ * is a single pass over the registers, so the cost of a step is fixed by the
+ * memory bandwidth for very large systems.
+ * @author Jeremiah O'Neil
+ * @copyright GNU Public License. */
+#ifndef INC_RKLS_hpp // #include guard
+#define INC_RKLS_hpp // ensure this file is included at most once per unit
+
+#include "rkab.hpp" // rkab_tol_control, rkab_trajectory_output
+#include "rkab_observe.hpp" // rkab_chunk_output
+
+/** @brief Function template for the integration loop of low-storage
+ * adaptive step size Runge-Kutta methods.
+ * @details Solves a given system over parameterized domain as
+ * rkab_integrate() does, handing each accepted step to an output policy, with
+ * the step size control of rkab_tol_control, but by a method in 2N form; see
+ * the file description. The rkab_step handed to the policy carries no
+ * derivatives, so policies which interpolate (calling f1()) don't apply.
+ * @param u_init The initial state array of the system.
+ * @param dim The dimension of the system.
+ * @param maxsteps The maximum number of iterations to run.
+ * @param tol The relative tolerance or a pointer to an array of relative
+ * tolerances for the local error of the system at each step.
+ * @param t The initial value of the system parameter.
+ * @param t_end The target value of the system parameter.
+ * @param get_f A callback function get_f(t, *u_t, *f) which writes the
+ * derivative of u at system parameter t and state u_t to array f.
+ * @param out The output policy; see rkab_integrate_control().
+ * @param numfailures [out] The number of steps where a failure occured.
+ * @param stats Where to record the statistics of the solve, if instrumented.
+ * @return The number of accepted steps.
+ * @tparam Tab Low-storage tableau type, bound on instantiation, defining a
+ * particular method. It provides constexpr members 'order', the order of the
+ * method, 'stages', and arrays 'A', 'B', 'C' and 'E' of the coefficients of
+ * the 2N form and the error weights, one per stage (A[0] is unused). See
+ * rkls43.cpp for an example.
+ * @tparam T Floating-point compatible data type.
+ * @tparam Ttol Tolerance type: should be (scalar) T or (array) T*.
+ * @tparam Output Output policy type. */
+template<class Tab, typename T, typename tolT, class Output>
+int rkls_integrate(T *u_init, int dim, int maxsteps, tolT tol, T t, T t_end,
+                   void (*get_f)(T, T*, T*), Output &out, int &numfailures
+                   ODE_STATS(, rkab_stats &stats))
+{
+    // The registers, the derivative, and the state at the start of the step
+    vector<T> block(5 * (size_t)dim);
+    T *u = block.data();
+    T *du = u + dim;
+    T *e = du + dim;
+    T *f = e + dim;
+    T *u_prev = f + dim;
+    rkab_tol_control<T, tolT> ctl(tol, Tab::order);
+
+    // Initialize
+    numfailures = 0;
+    int numsteps = 0;
+    bool stop = false; // set when the output policy calls a halt
+    bool f0_valid = false; // unused: the control evaluates no derivative
+    copy(u_init, u_init + dim, u_prev);
+    ODE_STATS(rkab_probe<T> probe(stats, get_f); get_f = probe.get_f();)
+
+    T h = ctl.initial_step(dim, t, t_end, u_prev, 0, 0, 0, 0, f0_valid);
+    int t_dir = (t_end >= t) ? 1 : -1;
+    h *= t_dir;
+
+    // Main loop
+    while (!stop && numsteps < maxsteps && t_dir * (t_end - t) > 0)
+    {
+        bool failures = false;
+        ODE_STATS(long pessimistic = 0;) // rejections since the first
+        T hmin = 16 * boost::math::ulp(t);
+        if (abs(h) < hmin) {
+            h = t_dir * hmin;
+        }
+        if (t_dir * (t_end - t - h) < 0){
+            h = t_end - t;
+        }
+
+        // Loop for advancing one step
+        while (true)
+        {
+            // The first stage starts the registers afresh
+            get_f(t, u_prev, f);
+            const T B0 = (T)Tab::B[0], E0 = h * (T)Tab::E[0];
+            for (int i = 0; i < dim; ++i) {
+                du[i] = h * f[i];
+                u[i] = u_prev[i] + B0 * du[i];
+                e[i] = E0 * f[i];
+            }
+            for (int k = 1; k < Tab::stages; ++k) {
+                get_f(t + h * (T)Tab::C[k], u, f);
+                const T A = (T)Tab::A[k], B = (T)Tab::B[k];
+                const T E = h * (T)Tab::E[k];
+                for (int i = 0; i < dim; ++i) {
+                    du[i] = A * du[i] + h * f[i];
+                    u[i] += B * du[i];
+                    e[i] += E * f[i];
+                }
+            }
+            // The embedded state, in place of the error
+            for (int i = 0; i < dim; ++i) {
+                e[i] = u[i] - e[i];
+            }
+
+            T acceptability = ctl.acceptability(dim, u_prev, e, u);
+            if (acceptability > 1 || abs(h) <= hmin)
+            { // Accept the step
+                ++numsteps;
+                ODE_STATS(stats.numhmin += !(acceptability > 1);
+                          rkab_stats_step(stats, h);)
+                rkab_step<T> s = {t, t + h, u_prev, u, 0, 0, get_f, 0};
+                ODE_STATS(probe.output_begin();)
+                stop = !out.step(numsteps, s);
+                ODE_STATS(probe.output_end();)
+                t = s.t1;
+                swap(u_prev, u);
+                h *= ctl.accept(acceptability);
+                break;
+            }
+            else
+            { // Reject the step
+                ODE_STATS(++stats.numrejections;)
+                if (!failures)
+                {
+                    failures = true;
+                    ++numfailures;
+                    h *= ctl.reject(acceptability, true);
+                } else {
+                    h *= ctl.reject(acceptability, false);
+                    ODE_STATS(++stats.numpessimistic;
+                              stats.maxpessimistic =
+                                  max(stats.maxpessimistic, ++pessimistic);)
+                }
+            }
+        }
+    }
+    ODE_STATS(probe.output_begin();)
+    out.finish(numsteps, t, u_prev);
+    ODE_STATS(probe.output_end();)
+
+    return numsteps;
+}
+
+/** @brief Function template for low-storage adaptive step size Runge-Kutta
+ * methods.
+ * @details Solves a given system with rkls_integrate(), as rkab() does with
+ * rkab_integrate().
+ * @tparam Tab Low-storage tableau type; see rkls_integrate(). */
+template<class Tab, typename T, typename tolT>
+struct results_rkab<T> *rkls(T *u_init, int dim, int maxsteps, tolT tol,
+                             T t, T t_end, void (*get_f)(T, T*, T*))
+{
+    rkab_workspace<T> ws; // the output arena; its arrays go unused
+    rkab_trajectory_output<T> out(ws, dim);
+    int numfailures;
+    int numsteps = rkls_integrate<Tab, T, tolT>(u_init, dim, maxsteps, tol,
+                                                t, t_end, get_f, out,
+                                                numfailures
+                                                ODE_STATS(, ws.stats));
+    return new_results_rkab(numsteps, numfailures, ws.tvec, ws.u,
+                            ODE_STATS_OF(ws));
+}
+
+/** @brief Function template for low-storage adaptive step size Runge-Kutta
+ * methods which stream their output.
+ * @details Solves a given system with rkls_integrate(), as rkab_observe()
+ * does with rkab_integrate(), so that the memory used is that of the method
+ * alone.
+ * @tparam Tab Low-storage tableau type; see rkls_integrate(). */
+template<class Tab, typename T, typename tolT>
+int rkls_observe(T *u_init, int dim, int maxsteps, tolT tol, T t, T t_end,
+                 void (*get_f)(T, T*, T*), rkab_observer<T> *obs,
+                 int *numfailures)
+{
+    rkab_chunk_output<T> out(*obs, dim);
+    ODE_STATS(rkab_stats stats;)
+    int failures;
+    int numsteps = rkls_integrate<Tab, T, tolT>(u_init, dim, maxsteps, tol,
+                                                t, t_end, get_f, out,
+                                                failures ODE_STATS(, stats));
+    if (numfailures) {
+        *numfailures = failures;
+    }
+    return numsteps;
+}
+
+#endif // #include guard
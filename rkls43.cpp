@@ -0,0 +1,50 @@
+/** @file
+ * @brief Low-storage Runge-Kutta method of Carpenter and Kennedy, fourth
+ * order in five stages, with an embedded third-order error estimate
+ * @details Provides a C interface; see adaptive_step_rk.h for details.
+ * @author Jeremiah O'Neil
+ * @copyright GNU Public License. */
+#include "rkls.hpp" // templates
+#include "adaptive_step_rk.h" // interface
+
+/** @brief Tableau of the five-stage fourth-order 2N method of Carpenter and
+ * Kennedy (NASA TM-109112, 1994), as a type to bind to rkls().
+ * @details The error weights E are b - b', where b are the weights of the
+ * method in Butcher form and b' those of the third-order method on the same
+ * stages with b'_2 = 0. */
+struct tableau_rkls43
+{
+    static constexpr int order = 4, stages = 5;
+    static constexpr long double
+        A[] = {0, -567301805773/1357537059087.L,
+               -2404267990393/2016746695238.L,
+               -3550918686646/2091501179385.L,
+               -1275806237668/842570457699.L},
+        B[] = {1432997174477/9575080441755.L,
+               5161836677717/13612068292357.L,
+               1720146321549/2090206949498.L,
+               3134564353537/4481467310338.L,
+               2277821191437/14882151754819.L},
+        C[] = {0, 1432997174477/9575080441755.L,
+               2526269341429/6820363962896.L,
+               2006345519317/3224310063776.L,
+               2802321613138/2924317926251.L},
+        E[] = {-0.160334356410082354277928004499L,
+               0.344743042340567075203092710459L,
+               -0.244073126594159540034843496310L,
+               0.0546515270795736952348743100306L,
+               0.00501291358410112387480451744787L};
+};
+constexpr long double tableau_rkls43::A[], tableau_rkls43::B[],
+                      tableau_rkls43::C[], tableau_rkls43::E[];
+
+/** Instantiate as defined in adaptive_step_rk.h, binding the tableau to an
+ * rkls function instance.
+ * Should be used through MAP_TARGETS_TO(). */
+#define INST_RKLS43(T, Tid)                                          \
+    INST_RKLS(ls43##Tid, T, T, tableau_rkls43)                       \
+    INST_RKLS(ls43_arrtol##Tid, T, T *, tableau_rkls43)              \
+    INST_RKLS_OBSERVE(ls43_observe##Tid, T, T, tableau_rkls43)       \
+    INST_RKLS_OBSERVE(ls43_observe_arrtol##Tid, T, T *, tableau_rkls43)
+
+MAP_TARGETS_TO(INST_RKLS43)
@@ -0,0 +1,18 @@
+/** @file
+ * @brief Shampine-Reichelt Rosenbrock method: adaptive step linearly implicit
+ * implementation for stiff systems
+ * @details Provides a C interface; see adaptive_step_rk.h for details. The
+ * formula is fixed in rosenbrock.hpp.
+ * @author Jeremiah O'Neil
+ * @copyright GNU Public License. */
+#include "rosenbrock.hpp" // templates
+#include "adaptive_step_rk.h" // interface
+
+/** Instantiate as defined in adaptive_step_rk.h.
+ * Should be used through MAP_TARGETS_TO(). */
+#define INST_ROS23(T, Tid)                        \
+    INST_ROSENBROCK(23##Tid, T, T)                \
+    INST_ROSENBROCK(23_arrtol##Tid, T, T *)       \
+    INST_ROSENBROCK_OPT(23_opt##Tid, T)
+
+MAP_TARGETS_TO(INST_ROS23)
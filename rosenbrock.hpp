@@ -0,0 +1,517 @@
+/** @file
+ * @brief Templates for an adaptive step size Rosenbrock solver of stiff
+ * systems.
+ * @details Provides a template rosenbrock() implementing the linearly implicit
+ * Rosenbrock triple of Shampine and Reichelt (as in MATLAB's ode23s): a second
+ * order L-stable formula with a third order error estimate, which is FSAL and
+ * needs one LU factorization of W = I - h*d*J per step size. The formula is a
+ * W-method, so it keeps its order for any approximation of the Jacobian J;
+ * I exploit that to reuse J, and the factorization of W, for as long as the
+ * step size holds, re-evaluating J only along with W or after a rejection.
+ * J is taken from a callback or by finite differences, and may be banded,
+ * which makes large systems (eg., method-of-lines PDEs) cost O(dim) per step
+ * rather than O(dim^3). Also provides rosenbrock_opt(), which measures the
+ * error in a norm weighted by absolute and relative tolerances, as rkab_opt()
+ * does; stiff systems often have components that decay to near zero, which
+ * a relative error norm resolves with needlessly small steps.
+ * @author Jeremiah O'Neil
+ * @copyright GNU Public License. */
+#ifndef INC_ROSENBROCK_hpp // #include guard
+#define INC_ROSENBROCK_hpp // ensure this file is included at most once per unit
+
+#include "rkab.hpp" // results_rkab, rkab_step, output policies
+#include "rkab_control.hpp" // rkab_pid_control
+
+/// The order of the error estimate of rosenbrock(), to which its step size
+/// control adapts.
+constexpr int rosenbrock_order = 3;
+
+/** @brief Structure template for a square matrix in band storage with its LU
+ * factorization in place.
+ * @details Row i holds columns i-ml through i+ml+mu; the extra ml columns make
+ * room for the fill-in of partial pivoting. A matrix with ml or mu negative
+ * is stored dense instead. As in LAPACK's banded solvers, the row interchanges
+ * are applied to the right-hand side as the elimination goes, so the
+ * multipliers are never swapped.
+ * @tparam T Floating-point compatible data type. */
+template<typename T>
+struct band_lu
+{
+    int n; ///< The number of rows and columns
+    int ml, mu; ///< The lower and upper bandwidths (n-1 each if dense)
+    int width; ///< The length of a stored row
+    bool dense; ///< Whether the storage is dense
+    T *a; ///< The elements, then the factorization
+    int *piv; ///< The row interchanged with each row in elimination
+
+    band_lu() : n(0), ml(0), mu(0), width(0), dense(true), a(0), piv(0) {}
+    ~band_lu()
+    {
+        delete [] a;
+        delete [] piv;
+    }
+
+    /// Size for an n by n matrix of bandwidths ml and mu.
+    void reserve(int n, int ml, int mu)
+    {
+        delete [] a;
+        delete [] piv;
+        this->n = n;
+        dense = (ml < 0 || mu < 0 || ml + mu >= n - 1);
+        this->ml = dense ? n - 1 : ml;
+        this->mu = dense ? n - 1 : mu;
+        width = dense ? n : 2 * ml + mu + 1;
+        a = new T[n * width];
+        piv = new int[n];
+    }
+
+    /// Element (i, j), which must lie within the stored band.
+    T &at(int i, int j)
+    {
+        return a[dense ? i * n + j : i * width + j - i + ml];
+    }
+
+    /** @brief Factor in place by Gaussian elimination with partial pivoting.
+     * @return False if the matrix is singular. */
+    bool factor()
+    {
+        for (int k = 0; k < n; ++k) {
+            const int last = min(n - 1, k + ml); // rows reaching column k
+            const int end = min(n - 1, k + ml + mu); // columns after fill
+            int p = k;
+            for (int i = k + 1; i <= last; ++i) {
+                if (abs(at(i, k)) > abs(at(p, k))) {
+                    p = i;
+                }
+            }
+            piv[k] = p;
+            if (at(p, k) == 0) {
+                return false;
+            }
+            if (p != k) {
+                for (int j = k; j <= end; ++j) {
+                    swap(at(k, j), at(p, j));
+                }
+            }
+            const T pivot = at(k, k);
+            for (int i = k + 1; i <= last; ++i) {
+                const T l = (at(i, k) /= pivot);
+                if (l != 0) {
+                    for (int j = k + 1; j <= end; ++j) {
+                        at(i, j) -= l * at(k, j);
+                    }
+                }
+            }
+        }
+        return true;
+    }
+
+    /// Overwrite b with the solution x of A x = b, given the factorization.
+    void solve(T *b)
+    {
+        for (int k = 0; k < n; ++k) {
+            if (piv[k] != k) {
+                swap(b[k], b[piv[k]]);
+            }
+            const int last = min(n - 1, k + ml);
+            for (int i = k + 1; i <= last; ++i) {
+                b[i] -= at(i, k) * b[k];
+            }
+        }
+        for (int k = n - 1; k >= 0; --k) {
+            const int end = min(n - 1, k + ml + mu);
+            T s = b[k];
+            for (int j = k + 1; j <= end; ++j) {
+                s -= at(k, j) * b[j];
+            }
+            b[k] = s / at(k, k);
+        }
+    }
+
+private:
+    // Owns its arrays; not to be copied
+    band_lu(const band_lu &);
+    band_lu &operator=(const band_lu &);
+};
+
+/** @brief Structure template for the scratch memory of rosenbrock().
+ * @details As rkab_workspace, for the Rosenbrock solver.
+ * @tparam T Floating-point compatible data type. */
+template<typename T>
+struct rosenbrock_workspace
+{
+    int dim; ///< The dimension the arrays are sized for
+    int ml, mu; ///< The bandwidths the arrays are sized for
+    T *u_prev, *ua, *ub, *u_k; ///< State arrays of one step
+    T *f0, *f1, *f2; ///< Derivatives at the stages
+    T *k1, *k2, *k3; ///< Stage increments
+    T *dfdt; ///< Partial derivative of f in t
+    T *jac; ///< Jacobian in compact (band) storage
+    T *f_next; ///< Scratch derivative for finite differences and output
+    band_lu<T> w; ///< W = I - h*d*J and its factorization
+    vector<T> tvec; ///< The parameter at each accepted step
+    vector<T> u; ///< The state at each accepted step, concatenated
+    ODE_STATS(rkab_stats stats;) ///< The statistics of the last solve
+
+    rosenbrock_workspace() :
+        dim(0), ml(0), mu(0), u_prev(0), ua(0), ub(0), u_k(0), f0(0), f1(0),
+        f2(0), k1(0), k2(0), k3(0), dfdt(0), jac(0), f_next(0) {}
+    ~rosenbrock_workspace()
+    {
+        release();
+    }
+
+    /// Ensure the arrays fit a system of dimension dim and bandwidths ml, mu.
+    void reserve(int dim, int ml, int mu)
+    {
+        if (dim == this->dim && ml == this->ml && mu == this->mu) {
+            return;
+        }
+        release();
+        this->dim = dim;
+        this->ml = ml;
+        this->mu = mu;
+        T **arrays[] = {&u_prev, &ua, &ub, &u_k, &f0, &f1, &f2,
+                        &k1, &k2, &k3, &dfdt, &f_next};
+        for (size_t a = 0; a < sizeof(arrays) / sizeof(*arrays); ++a) {
+            *arrays[a] = new T[dim];
+        }
+        w.reserve(dim, ml, mu);
+        jac = new T[w.dense ? dim * dim : dim * (ml + mu + 1)];
+    }
+
+private:
+    void release()
+    {
+        T *arrays[] = {u_prev, ua, ub, u_k, f0, f1, f2,
+                       k1, k2, k3, dfdt, f_next, jac};
+        for (size_t a = 0; a < sizeof(arrays) / sizeof(*arrays); ++a) {
+            delete [] arrays[a];
+        }
+        dim = 0;
+    }
+    // Owns its arrays; not to be copied
+    rosenbrock_workspace(const rosenbrock_workspace &);
+    rosenbrock_workspace &operator=(const rosenbrock_workspace &);
+};
+
+/** @brief Function template for the Jacobian by finite differences.
+ * @details Writes J in the compact storage described at rosenbrock(). For a
+ * banded J the columns are perturbed in groups of ml+mu+1 which touch no row
+ * in common, so it costs ml+mu+1 evaluations of f rather than dim.
+ * @param dim The dimension of the system.
+ * @param ml The lower bandwidth, or negative if J is dense.
+ * @param mu The upper bandwidth, or negative if J is dense.
+ * @param t The parameter.
+ * @param u The state; restored on return.
+ * @param f0 The derivative at (t, u).
+ * @param get_f The derivative callback.
+ * @param jac [out] The Jacobian.
+ * @param f_tmp Scratch array of dim elements.
+ * @param du Scratch array of dim elements. */
+template<typename T>
+void jacobian_fd(int dim, int ml, int mu, T t, T *u, const T *f0,
+                 void (*get_f)(T, T*, T*), T *jac, T *f_tmp, T *du)
+{
+    const bool dense = (ml < 0 || mu < 0 || ml + mu >= dim - 1);
+    const int groups = dense ? dim : ml + mu + 1;
+    const int row = dense ? dim : ml + mu + 1; // stored row length
+    const T eps = sqrt(numeric_limits<T>::epsilon());
+    for (int g = 0; g < groups; ++g) {
+        for (int j = g; j < dim; j += groups) {
+            T u_j = u[j];
+            u[j] += eps * max(abs(u_j), sqrt(numeric_limits<T>::min()));
+            du[j] = u[j] - u_j; // the perturbation actually made
+        }
+        get_f(t, u, f_tmp);
+        for (int j = g; j < dim; j += groups) {
+            u[j] -= du[j];
+            const int lo = dense ? 0 : max(0, j - mu);
+            const int hi = dense ? dim - 1 : min(dim - 1, j + ml);
+            for (int i = lo; i <= hi; ++i) {
+                jac[dense ? i * row + j : i * row + j - i + ml] =
+                    (f_tmp[i] - f0[i]) / du[j];
+            }
+        }
+    }
+}
+
+/** @brief Function template for the Rosenbrock solver, given a step size
+ * control and an output policy.
+ * @details The integration loop of rosenbrock(), handing each accepted step
+ * to the output policy as rkab_integrate_control() does. The control is as
+ * described there, for the order rosenbrock_order. The step size is only
+ * changed if the control would grow it by 1.2 or more, or shrink it, since
+ * each change costs a factorization of W.
+ * @param ws The scratch memory to use; see rosenbrock_workspace.
+ * @param u_init The initial state array of the system.
+ * @param dim The dimension of the system.
+ * @param maxsteps The maximum number of iterations to run.
+ * @param ctl The step size control; see rkab_integrate_control().
+ * @param t The initial value of the system parameter.
+ * @param t_end The target value of the system parameter.
+ * @param get_f The derivative callback; see rosenbrock().
+ * @param get_J The Jacobian callback, or NULL; see rosenbrock().
+ * @param ml The lower bandwidth of the Jacobian, or negative if dense.
+ * @param mu The upper bandwidth of the Jacobian, or negative if dense.
+ * @param out The output policy.
+ * @param numfailures [out] The number of steps where a failure occured.
+ * @return The number of accepted steps.
+ * @tparam T Floating-point compatible data type.
+ * @tparam Control Step size control type.
+ * @tparam Output Output policy type; see rkab_integrate(). */
+template<typename T, class Control, class Output>
+int rosenbrock_integrate(rosenbrock_workspace<T> &ws, T *u_init, int dim,
+                         int maxsteps, Control &ctl, T t, T t_end,
+                         void (*get_f)(T, T*, T*),
+                         void (*get_J)(T, T*, T*), int ml, int mu,
+                         Output &out, int &numfailures)
+{
+    // The coefficients of the formula
+    const T d = 1 / (2 + sqrt((T)2));
+    const T e32 = 6 + sqrt((T)2);
+    const T hold_adapt = 1.2; // keep h, and W, if it would grow less
+
+    // Temporary arrays
+    ws.reserve(dim, ml, mu);
+    T *u_prev = ws.u_prev, *ua = ws.ua, *ub = ws.ub, *u_k = ws.u_k;
+    T *f0 = ws.f0, *f1 = ws.f1, *f2 = ws.f2;
+    T *k1 = ws.k1, *k2 = ws.k2, *k3 = ws.k3, *dfdt = ws.dfdt;
+    band_lu<T> &w = ws.w;
+    const int row = w.dense ? dim : ml + mu + 1; // stored row length of J
+
+    // Initialize
+    numfailures = 0;
+    int numsteps = 0;
+    bool stop = false; // set when the output policy calls a halt
+    bool f0_valid = false; // whether f0 holds f(t, u_prev)
+    bool jac_valid = false; // whether J (and dfdt) may be used
+    bool jac_fresh = false; // whether J was evaluated at (t, u_prev)
+    T h_w = 0; // the step size W was factored for, or 0 if none
+    copy(u_init, u_init + dim, u_prev);
+    ODE_STATS(rkab_probe<T> probe(ws.stats, get_f); get_f = probe.get_f();)
+
+    // Guess an initial step size
+    T h = ctl.initial_step(dim, t, t_end, u_prev, f0, u_k, f1, get_f,
+                           f0_valid);
+    // Choose the sign of h according to the direction of propagation
+    int t_dir = (t_end >= t) ? 1 : -1;
+    h *= t_dir;
+
+    // Main loop
+    while (!stop && numsteps < maxsteps && t_dir * (t_end - t) > 0)
+    {
+        bool failures = false;
+        ODE_STATS(long pessimistic = 0;) // rejections since the first
+        T hmin = 16 * boost::math::ulp(t);
+        // hmin is the minimum meaningful magnitude of h
+        if (abs(h) < hmin) { // abs(h) should be >= hmin
+            h = t_dir * hmin;
+        }
+        // But make sure to hit the last step exactly
+        if (t_dir * (t_end - t - h) < 0){
+            h = t_end - t;
+        }
+
+        // Loop for advancing one step
+        while (true)
+        {
+            if (!f0_valid) {
+                get_f(t, u_prev, f0);
+                f0_valid = true;
+            }
+            if (!jac_valid) { // J and df/dt at (t, u_prev)
+                if (get_J) {
+                    get_J(t, u_prev, ws.jac);
+                } else {
+                    jacobian_fd(dim, ml, mu, t, u_prev, f0, get_f,
+                                ws.jac, ws.f_next, k1);
+                }
+                T dt = sqrt(numeric_limits<T>::epsilon()) * max(abs(t), (T)1);
+                get_f(t + dt, u_prev, dfdt);
+                dt = (t + dt) - t;
+                for (int i = 0; i < dim; ++i) {
+                    dfdt[i] = (dfdt[i] - f0[i]) / dt;
+                }
+                jac_valid = jac_fresh = true;
+                h_w = 0;
+            }
+            bool singular = false;
+            if (h != h_w) { // W = I - h*d*J, factored
+                fill(w.a, w.a + dim * w.width, 0);
+                for (int i = 0; i < dim; ++i) {
+                    const int lo = w.dense ? 0 : max(0, i - ml);
+                    const int hi = w.dense ? dim - 1 : min(dim - 1, i + mu);
+                    for (int j = lo; j <= hi; ++j) {
+                        const T jac_ij = ws.jac[w.dense ? i * row + j
+                                                        : i * row + j - i + ml];
+                        w.at(i, j) = -h * d * jac_ij;
+                    }
+                    w.at(i, i) += 1;
+                }
+                singular = !w.factor();
+                h_w = singular ? 0 : h;
+            }
+
+            T acceptability = 0;
+            if (!singular) {
+                // k1 = W^-1 (f0 + h*d*dfdt)
+                for (int i = 0; i < dim; ++i) {
+                    k1[i] = f0[i] + h * d * dfdt[i];
+                }
+                w.solve(k1);
+                // k2 = W^-1 (f1 - k1) + k1, f1 = f(t + h/2, u + h/2*k1)
+                for (int i = 0; i < dim; ++i) {
+                    u_k[i] = u_prev[i] + h / 2 * k1[i];
+                }
+                get_f(t + h / 2, u_k, f1);
+                for (int i = 0; i < dim; ++i) {
+                    k2[i] = f1[i] - k1[i];
+                }
+                w.solve(k2);
+                for (int i = 0; i < dim; ++i) {
+                    k2[i] += k1[i];
+                    ub[i] = u_prev[i] + h * k2[i]; // the solution
+                }
+                // k3 = W^-1 (f2 - e32*(k2 - f1) - 2*(k1 - f0) + h*d*dfdt)
+                get_f(t + h, ub, f2);
+                for (int i = 0; i < dim; ++i) {
+                    k3[i] = f2[i] - e32 * (k2[i] - f1[i]) - 2 * (k1[i] - f0[i])
+                          + h * d * dfdt[i];
+                }
+                w.solve(k3);
+                // ua - ub is the error estimate
+                for (int i = 0; i < dim; ++i) {
+                    ua[i] = ub[i] + h / 6 * (k1[i] - 2 * k2[i] + k3[i]);
+                }
+                // acceptability = (tolerance) / (error)
+                acceptability = ctl.acceptability(dim, u_prev, ua, ub);
+            }
+            // If the step is acceptable or the step size is minimal
+            if (!singular && (acceptability > 1 || abs(h) <= hmin))
+            { // Accept the step
+                ++numsteps;
+                ODE_STATS(ws.stats.numhmin += !(acceptability > 1);
+                          rkab_stats_step(ws.stats, h);)
+                // The formula is FSAL: f2 was evaluated at ub
+                rkab_step<T> s = {t, t + h, u_prev, ub, f0, f2,
+                                  get_f, ws.f_next};
+                ODE_STATS(probe.output_begin();)
+                stop = !out.step(numsteps, s);
+                ODE_STATS(probe.output_end();)
+                t = s.t1;
+                swap(u_prev, ub);
+                swap(f0, f2);
+                jac_fresh = false;
+                // Adapt step size, unless by a factor in [1, hold_adapt),
+                //  which would cost a factorization for little
+                T adapt = ctl.accept(acceptability);
+                if (adapt >= hold_adapt || adapt < 1) {
+                    h *= adapt;
+                    jac_valid = false; // refresh J along with W
+                }
+                break;
+            }
+            else
+            { // Reject the step
+                ODE_STATS(++ws.stats.numrejections;)
+                if (!jac_fresh) { // try again with a fresh Jacobian first
+                    jac_valid = false;
+                }
+                if (!failures)
+                {
+                    failures = true;
+                    ++numfailures;
+                    h *= ctl.reject(acceptability, true); // Adapt step size
+                } else { // We underestimated error! Be pessimistic.
+                    h *= ctl.reject(acceptability, false);
+                    ODE_STATS(++ws.stats.numpessimistic;
+                              ws.stats.maxpessimistic =
+                                  max(ws.stats.maxpessimistic, ++pessimistic);)
+                }
+            }
+        }
+    }
+    ODE_STATS(probe.output_begin();)
+    out.finish(numsteps, t, u_prev);
+    ODE_STATS(probe.output_end();)
+
+    return numsteps;
+}
+
+/** @brief Function template for an adaptive step size Rosenbrock method for
+ * stiff systems.
+ * @details Solves a given system over parameterized domain to given relative
+ * tolerance in local error, as rkab() does, with the linearly implicit
+ * formula described above. The Jacobian J = df/du is stored row-major: if
+ * dense, J_ij at jac[i * dim + j]; if banded with lower and upper bandwidths
+ * ml and mu, J_ij for -ml <= j - i <= mu at jac[i * (ml + mu + 1) + j - i +
+ * ml].
+ * @param u_init The initial state array of the system.
+ * @param dim The dimension of the system.
+ * @param maxsteps The maximum number of iterations to run.
+ * @param tol The relative tolerance or a pointer to an array of relative
+ * tolerances for the local error of the system at each step.
+ * @param t The initial value of the system parameter.
+ * @param t_end The target value of the system parameter.
+ * @param get_f A callback function get_f(t, *u_t, *f) which writes the
+ * derivative of u at system parameter t and state u_t to array f.
+ * @param get_J A callback function get_J(t, *u_t, *jac) which writes the
+ * Jacobian at system parameter t and state u_t to array jac, or NULL to
+ * approximate it by finite differences of f.
+ * @param ml The lower bandwidth of the Jacobian, or negative if it is dense.
+ * @param mu The upper bandwidth of the Jacobian, or negative if it is dense.
+ * @tparam T Floating-point compatible data type.
+ * @tparam Ttol Tolerance type: should be (scalar) T or (array) T*. */
+template<typename T, typename tolT>
+struct results_rkab<T> *rosenbrock(T *u_init, int dim, int maxsteps,
+                                   tolT tol, T t, T t_end,
+                                   void (*get_f)(T, T*, T*),
+                                   void (*get_J)(T, T*, T*), int ml, int mu)
+{
+    rosenbrock_workspace<T> ws; // RAII; deleted automatically.
+    rkab_trajectory_output<T> out(ws, dim);
+    rkab_tol_control<T, tolT> ctl(tol, rosenbrock_order);
+    int numfailures;
+    int numsteps = rosenbrock_integrate<T>(ws, u_init, dim, maxsteps, ctl, t,
+                                           t_end, get_f, get_J, ml, mu, out,
+                                           numfailures);
+    return new_results_rkab(numsteps, numfailures, out.tvec, out.u,
+                            ODE_STATS_OF(ws));
+}
+
+/** @brief Function template for an adaptive step size Rosenbrock method for
+ * stiff systems, with a choice of step size control.
+ * @details Solves a given system as rosenbrock() does, with the error norm,
+ * tolerances, first step and controller given by rkab_options, as rkab_opt()
+ * does; see rkab_pid_control.
+ * @param u_init The initial state array of the system.
+ * @param dim The dimension of the system.
+ * @param maxsteps The maximum number of iterations to run.
+ * @param opts The options of the step size control.
+ * @param t The initial value of the system parameter.
+ * @param t_end The target value of the system parameter.
+ * @param get_f The derivative callback; see rosenbrock().
+ * @param get_J The Jacobian callback, or NULL; see rosenbrock().
+ * @param ml The lower bandwidth of the Jacobian, or negative if it is dense.
+ * @param mu The upper bandwidth of the Jacobian, or negative if it is dense.
+ * @tparam T Floating-point compatible data type. */
+template<typename T>
+struct results_rkab<T> *rosenbrock_opt(T *u_init, int dim, int maxsteps,
+                                       const rkab_options<T> *opts, T t,
+                                       T t_end, void (*get_f)(T, T*, T*),
+                                       void (*get_J)(T, T*, T*), int ml,
+                                       int mu)
+{
+    rosenbrock_workspace<T> ws; // RAII; deleted automatically.
+    rkab_trajectory_output<T> out(ws, dim);
+    rkab_pid_control<T> ctl(*opts, rosenbrock_order);
+    int numfailures;
+    int numsteps = rosenbrock_integrate<T>(ws, u_init, dim, maxsteps, ctl, t,
+                                           t_end, get_f, get_J, ml, mu, out,
+                                           numfailures);
+    return new_results_rkab(numsteps, numfailures, out.tvec, out.u,
+                            ODE_STATS_OF(ws));
+}
+
+#endif // #include guard
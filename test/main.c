@@ -23,6 +23,13 @@ int main()
         printf("%.4e: (%.4e, %.4e)\n", tstart + h*(n+1), u[2*n], u[2*n+1]);
     }
     free(u);
+
+    double u_rk4[2 * 10]; // every 100th state
+    int rows = rk4_stride(u_rk4, u0, 2, maxsteps, h, tstart, get_f_sho, 100);
+    for (int n = 0; n < rows; ++n){
+        printf("%.4e: (%.4e, %.4e)\n", tstart + 100*h*(n+1), u_rk4[2*n],
+               u_rk4[2*n+1]);
+    }
     
     results_rkab *res = rk45(u0, 2, maxsteps, 1e-6, tstart, tend, get_f_sho);
     printf("%d, %d\n", res->numsteps, res->numfailures);
@@ -30,4 +37,215 @@ int main()
         printf("%.4e: (%.4e, %.4e)\n", res->t[n], res->u[2*n], res->u[2*n+1]);
     }
     delete_results_rkab(res);
+
+    void get_f_sho_batch(double *t_n, double *u_n, double *f, int n)
+    {
+        for (int l = 0; l < n; ++l){
+            f[l] = u_n[n + l];
+            f[n + l] = -u_n[l];
+        }
+    }
+
+    double u0_batch[] = {0, 0, 0, 0, 1, 2, 3, 4}; // structure-of-arrays
+    results_rkab **res_batch = rk45_batch(u0_batch, 2, 4, maxsteps, 1e-6,
+                                          tstart, tend, get_f_sho_batch);
+    for (int l = 0; l < 4; ++l){
+        results_rkab *r = res_batch[l];
+        printf("%d, %d: (%.4e, %.4e)\n", r->numsteps, r->numfailures,
+               r->u[2*(r->numsteps-1)], r->u[2*(r->numsteps-1)+1]);
+    }
+    delete_results_rkab_array(res_batch, 4);
+
+    double t_obs[1], u_obs[2]; // just the final state
+    rkab_observer obs = {0, 1, t_obs, u_obs, NULL, NULL, 0};
+    int numfailures;
+    int numsteps = rk45_observe(u0, 2, maxsteps, 1e-6, tstart, tend,
+                                get_f_sho, &obs, &numfailures);
+    printf("%d, %d: %.4e: (%.4e, %.4e)\n", numsteps, numfailures,
+           t_obs[0], u_obs[0], u_obs[1]);
+
+    double t_eval[5] = {0, 1, 2, 3, 4}; // sample on a grid
+    results_rkab *res_teval = rk45_teval(u0, 2, maxsteps, 1e-6, tstart, tend,
+                                         get_f_sho, t_eval, 5);
+    for (int i = 0; i < res_teval->numsteps; ++i) {
+        printf("%.4e: (%.4e, %.4e)\n", res_teval->t[i],
+               res_teval->u[2*i], res_teval->u[2*i + 1]);
+    }
+    delete_results_rkab(res_teval);
+
+    results_rkab *res_fsal = rkdp54(u0, 2, maxsteps, 1e-6, tstart, tend,
+                                    get_f_sho); // first same as last
+    int last = res_fsal->numsteps - 1;
+    printf("%d, %d: %.4e: (%.4e, %.4e)\n", res_fsal->numsteps,
+           res_fsal->numfailures, res_fsal->t[last],
+           res_fsal->u[2*last], res_fsal->u[2*last + 1]);
+    delete_results_rkab(res_fsal);
+
+    rkab_options opts = {1e-6, 1e-6, NULL, NULL, RKAB_NORM_RMS,
+                         RKAB_CONTROL_PI, 0}; // absolute and relative
+    results_rkab *res_opt = rk45_opt(u0, 2, maxsteps, &opts, tstart, tend,
+                                     get_f_sho);
+    last = res_opt->numsteps - 1;
+    printf("%d, %d: %.4e: (%.4e, %.4e)\n", res_opt->numsteps,
+           res_opt->numfailures, res_opt->t[last],
+           res_opt->u[2*last], res_opt->u[2*last + 1]);
+    delete_results_rkab(res_opt);
+
+    rkab_context *ctx = rkab_context_create(2, 512); // reused, not copied
+    for (int i = 1; i <= 2; ++i) {
+        const results_rkab *r = rk45_solve(ctx, u0, maxsteps, 1e-6, tstart,
+                                           i * tend, get_f_sho);
+        last = r->numsteps - 1;
+        printf("%d, %d: %.4e: (%.4e, %.4e)\n", r->numsteps, r->numfailures,
+               r->t[last], r->u[2*last], r->u[2*last + 1]);
+    }
+    rkab_context_destroy(ctx);
+
+    rkab_parareal_options par = {4, 100, 1e-8, 0, 2, 0}; // 4 slices
+    results_rkab *res_par = rk45_parareal(u0, 2, maxsteps, 1e-6, tstart, tend,
+                                          get_f_sho, &par);
+    last = res_par->numsteps - 1;
+    printf("%d iterations; %d, %d: %.4e: (%.4e, %.4e)\n", par.numiter,
+           res_par->numsteps, res_par->numfailures, res_par->t[last],
+           res_par->u[2*last], res_par->u[2*last + 1]);
+    delete_results_rkab(res_par);
+
+    void get_f_sho_f(float t_n, float *u_n, float *f)
+    {
+        f[0] = u_n[1];
+        f[1] = -u_n[0];
+    }
+
+    // float stages, double state
+    results_rkab_d *res_fd = rk45_fd(u0, 2, maxsteps, 1e-6, tstart, tend,
+                                     get_f_sho_f);
+    last = res_fd->numsteps - 1;
+    printf("%d, %d: %.4e: (%.4e, %.4e)\n", res_fd->numsteps,
+           res_fd->numfailures, res_fd->t[last], res_fd->u[2*last],
+           res_fd->u[2*last + 1]);
+    delete_results_rkab_d(res_fd);
+
+    void get_f_sho_range(double t_n, double *u_n, double *f, int begin,
+                         int end)
+    {
+        for (int i = begin; i < end; ++i) {
+            f[i] = (i % 2) ? -u_n[i - 1] : u_n[i + 1];
+        }
+    }
+
+    double t_par[1], u_par[2]; // just the final state
+    rkab_observer obs_par = {0, 1, t_par, u_par, NULL, NULL, 0};
+    numsteps = rk45_parallel(u0, 2, maxsteps, 1e-6, tstart, tend, NULL,
+                             get_f_sho_range, 2, &obs_par, &numfailures);
+    printf("%d, %d: %.4e: (%.4e, %.4e)\n", numsteps, numfailures,
+           t_par[0], u_par[0], u_par[1]);
+
+    rkab_async *job = rk45_async(u0, 2, maxsteps, 1e-6, tstart, tend,
+                                 get_f_sho); // on a thread of its own
+    const results_rkab *res_async = rkab_async_wait(job);
+    last = res_async->numsteps - 1;
+    printf("%d, %d: %.4e: (%.4e, %.4e)\n", res_async->numsteps,
+           res_async->numfailures, res_async->t[last], res_async->u[2*last],
+           res_async->u[2*last + 1]);
+    rkab_async_destroy(job);
+
+    job = rk45_async(u0, 2, 100000000, 1e-6, tstart, 1e9, get_f_sho);
+    int steps_async = 0;
+    while (!rkab_async_poll(job, NULL, &steps_async, NULL)
+           && steps_async < 100); // wait for some progress
+    rkab_async_cancel(job);
+    res_async = rkab_async_wait(job);
+    printf("cancelled: %d\n", res_async->numsteps >= 100
+           && res_async->t[res_async->numsteps - 1] < 1e9);
+    rkab_async_destroy(job);
+
+    void get_f_sho_fast(double t_n, double *u_n, double *f)
+    { // a fast oscillator driven by the slow one (in u_n[2], u_n[3])
+        f[0] = 20 * u_n[1] + u_n[2];
+        f[1] = -20 * u_n[0];
+    }
+    void get_f_sho_slow(double t_n, double *u_n, double *f)
+    {
+        f[2] = u_n[3];
+        f[3] = -u_n[2];
+    }
+
+    double u0_mr[4] = {0, 1, 0, 1};
+    results_rkab *res_mr = rkdp54_multirate(u0_mr, 4, 2, maxsteps, 1e-6,
+                                            tstart, tend, get_f_sho_fast,
+                                            get_f_sho_slow);
+    last = res_mr->numsteps - 1;
+    printf("%d, %d: %.4e: (%.4e, %.4e, %.4e, %.4e)\n", res_mr->numsteps,
+           res_mr->numfailures, res_mr->t[last], res_mr->u[4*last],
+           res_mr->u[4*last + 1], res_mr->u[4*last + 2],
+           res_mr->u[4*last + 3]);
+    delete_results_rkab(res_mr);
+
+    results_rkab *res_ls = rkls43(u0, 2, maxsteps, 1e-6, tstart, tend,
+                                  get_f_sho); // two registers for the stages
+    last = res_ls->numsteps - 1;
+    printf("%d, %d: %.4e: (%.4e, %.4e)\n", res_ls->numsteps,
+           res_ls->numfailures, res_ls->t[last], res_ls->u[2*last],
+           res_ls->u[2*last + 1]);
+    delete_results_rkab(res_ls);
+
+    void get_f_fall(double t_n, double *u_n, double *f) // height, velocity
+    {
+        f[0] = u_n[1];
+        f[1] = -9.81;
+    }
+    void get_g_fall(double t_n, double *u_n, double *g)
+    {
+        g[0] = u_n[0]; // hits the ground: stop
+        g[1] = u_n[1] + 5; // passes 5 m/s downward
+    }
+
+    double u0_fall[] = {10, 0}, t_ev[2], u_ev[4];
+    int direction[] = {-1, -1}, terminal[] = {1, 0}, which[2];
+    rkab_events ev = {2, get_g_fall, direction, terminal, 2, t_ev, u_ev,
+                      which, 0};
+    results_rkab *res_ev = rk45_events(u0_fall, 2, maxsteps, 1e-6, 0, 10,
+                                       get_f_fall, &ev);
+    for (int i = 0; i < ev.count; ++i) {
+        printf("event %d: %.6e: (%.4e, %.4e)\n", which[i], t_ev[i],
+               u_ev[2*i], u_ev[2*i + 1]);
+    }
+    last = res_ev->numsteps - 1;
+    printf("%d, %d: %.6e: (%.4e, %.4e)\n", res_ev->numsteps,
+           res_ev->numfailures, res_ev->t[last], res_ev->u[2*last],
+           res_ev->u[2*last + 1]);
+    delete_results_rkab(res_ev);
+
+    void get_f_robertson(double t_n, double *u_n, double *f) // stiff
+    {
+        f[0] = -0.04 * u_n[0] + 1e4 * u_n[1] * u_n[2];
+        f[2] = 3e7 * u_n[1] * u_n[1];
+        f[1] = -f[0] - f[2];
+    }
+
+    double u0_stiff[] = {1, 0, 0};
+    results_rkab *res_stiff = ros23(u0_stiff, 3, 100000, 1e-4, 0, 40,
+                                    get_f_robertson, NULL, -1, -1);
+    last = res_stiff->numsteps - 1;
+    printf("%d, %d: %.4e: (%.4e, %.4e, %.4e)\n", res_stiff->numsteps,
+           res_stiff->numfailures, res_stiff->t[last], res_stiff->u[3*last],
+           res_stiff->u[3*last + 1], res_stiff->u[3*last + 2]);
+    const rkab_stats *stats = results_rkab_stats(res_stiff);
+    if (stats) { // only if built with `make INSTRUMENT=1`
+        printf("%ld evaluations, %ld rejections, %ld at hmin; "
+               "%.2e s in get_f, %.2e s in solver\n", stats->numevals,
+               stats->numrejections, stats->numhmin, stats->seconds_f,
+               stats->seconds_kernel);
+    }
+    delete_results_rkab(res_stiff);
+
+    rkab_options opts_stiff = {1e-4, 1e-8, NULL, NULL, RKAB_NORM_RMS,
+                               RKAB_CONTROL_PI, 0}; // u[1] is about 1e-5
+    res_stiff = ros23_opt(u0_stiff, 3, 100000, &opts_stiff, 0, 40,
+                          get_f_robertson, NULL, -1, -1);
+    last = res_stiff->numsteps - 1;
+    printf("%d, %d: %.4e: (%.4e, %.4e, %.4e)\n", res_stiff->numsteps,
+           res_stiff->numfailures, res_stiff->t[last], res_stiff->u[3*last],
+           res_stiff->u[3*last + 1], res_stiff->u[3*last + 2]);
+    delete_results_rkab(res_stiff);
 }
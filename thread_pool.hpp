@@ -0,0 +1,181 @@
+/** @file
+ * @brief A work-stealing thread pool for running independent tasks.
+ * @details Provides a class work_stealing_pool which runs a task over a range
+ * of indices on a set of persistent threads. Each worker starts with an equal
+ * share of the range and takes indices from the front of its share; a worker
+ * which runs out steals the back half of the share of another. This keeps all
+ * of the cores busy when the tasks take very different amounts of work, as
+ * adaptive solves do.
+ * @author Jeremiah O'Neil
+ * @copyright GNU Public License. */
+#ifndef INC_THREAD_POOL_hpp // #include guard
+#define INC_THREAD_POOL_hpp // ensure this file is included at most once per unit
+
+#include <condition_variable> // for condition_variable
+#include <functional> // for function
+#include <mutex> // for mutex, lock_guard, unique_lock
+#include <thread> // for thread, hardware_concurrency
+#include <vector> // for vectors (dynamic size arrays)
+using namespace std;
+
+
+/** @brief A pool of persistent worker threads with work stealing.
+ * @details The thread calling run() serves as worker 0 and the pool holds
+ * the rest, so a pool of one thread runs everything in the caller. */
+class work_stealing_pool
+{
+public:
+    /** @brief Start a pool.
+     * @param numthreads The number of workers, or the number of hardware
+     * threads if not positive. */
+    explicit work_stealing_pool(int numthreads) :
+        numworkers(numthreads > 0 ? numthreads
+                                  : max(1u, thread::hardware_concurrency())),
+        shares(numworkers), job(0), generation(0), numbusy(0), quit(false)
+    {
+        for (int w = 1; w < numworkers; ++w) {
+            threads.push_back(thread(&work_stealing_pool::serve, this, w));
+        }
+    }
+
+    ~work_stealing_pool()
+    {
+        {
+            lock_guard<mutex> lock(pool_mutex);
+            quit = true;
+        }
+        wake.notify_all();
+        for (size_t w = 0; w < threads.size(); ++w) {
+            threads[w].join();
+        }
+    }
+
+    /// The number of workers, including the caller of run().
+    int size() const
+    {
+        return numworkers;
+    }
+
+    /** @brief Run task(worker, index) for each index in [0, num).
+     * @details Blocks until every index is done. 'worker' is in [0, size())
+     * and identifies the thread, so tasks can keep per-worker scratch
+     * memory without locking.
+     * @param num The number of indices.
+     * @param task The task to run. */
+    void run(int num, const function<void(int, int)> &task)
+    {
+        {
+            lock_guard<mutex> lock(pool_mutex);
+            for (int w = 0; w < numworkers; ++w) {
+                lock_guard<mutex> share_lock(shares[w].lock);
+                shares[w].begin = (int)((long long)num * w / numworkers);
+                shares[w].end = (int)((long long)num * (w + 1) / numworkers);
+            }
+            job = &task;
+            numbusy = numworkers - 1;
+            ++generation;
+        }
+        wake.notify_all();
+        work(0);
+        unique_lock<mutex> lock(pool_mutex);
+        done.wait(lock, [this]{ return numbusy == 0; });
+        job = 0;
+    }
+
+private:
+    /// A range of indices left to a worker, guarded by its own lock.
+    struct share
+    {
+        mutex lock;
+        int begin, end;
+        share() : begin(0), end(0) {}
+    };
+
+    /// Loop of the pool's threads: wait for a job, work it, report back.
+    void serve(int w)
+    {
+        unsigned seen = 0;
+        while (true)
+        {
+            {
+                unique_lock<mutex> lock(pool_mutex);
+                wake.wait(lock, [&]{ return quit || generation != seen; });
+                if (quit) {
+                    return;
+                }
+                seen = generation;
+            }
+            work(w);
+            {
+                lock_guard<mutex> lock(pool_mutex);
+                --numbusy;
+            }
+            done.notify_all();
+        }
+    }
+
+    /// Run indices of worker w's share, then steal until none are left.
+    void work(int w)
+    {
+        int index;
+        while (pop(w, index) || steal(w, index)) {
+            (*job)(w, index);
+        }
+    }
+
+    /// Take the next index from the front of worker w's own share.
+    bool pop(int w, int &index)
+    {
+        lock_guard<mutex> lock(shares[w].lock);
+        if (shares[w].begin >= shares[w].end) {
+            return false;
+        }
+        index = shares[w].begin++;
+        return true;
+    }
+
+    /** @brief Move the back half of another worker's share to worker w and
+     * take its first index.
+     * @details Victims are tried in turn starting after w, so thieves spread
+     * over the pool; a worker gives up once every share is empty. */
+    bool steal(int w, int &index)
+    {
+        for (int k = 1; k < numworkers; ++k)
+        {
+            share &victim = shares[(w + k) % numworkers];
+            int begin, end;
+            {
+                lock_guard<mutex> lock(victim.lock);
+                int left = victim.end - victim.begin;
+                if (left <= 0) {
+                    continue;
+                }
+                end = victim.end;
+                begin = victim.end - (left + 1) / 2;
+                victim.end = begin;
+            }
+            lock_guard<mutex> lock(shares[w].lock);
+            shares[w].begin = begin + 1;
+            shares[w].end = end;
+            index = begin;
+            return true;
+        }
+        return false;
+    }
+
+    const int numworkers;
+    vector<share> shares;
+    vector<thread> threads;
+    const function<void(int, int)> *job;
+    mutex pool_mutex; // guards generation, numbusy, quit
+    condition_variable wake, done;
+    unsigned generation;
+    int numbusy;
+    bool quit;
+
+    // Owns its threads; not to be copied
+    work_stealing_pool(const work_stealing_pool &);
+    work_stealing_pool &operator=(const work_stealing_pool &);
+};
+
+#endif // #include guard